@@ -0,0 +1,157 @@
+#include "FDM_AmericanOption.hpp"
+#include "FDM_Kernel.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Constructor implementation
+FDMAmerican::FDMAmerican(const EuropeanOption& _option, double _M, double _alpha_temp, bool _isPut, FDMScheme _scheme,
+                         FDMAmericanSolver _linearSolver, double _omega, double _tol, bool _storeMesh) {
+    t = _option.t;      // Current time
+    S = _option.S;      // Current stock price
+    K = _option.K;      // Strike price
+    T = _option.T;      // Time to maturity
+    sigma = _option.sigma;  // Volatility of the stock
+    r = _option.r;      // Risk-free rate
+    q = _option.q;      // Dividend yield
+    M = _M;      // meshsize
+    alpha_temp = _alpha_temp;
+    isPut = _isPut;
+    Setup_grid();
+    scheme = _scheme;
+    storeMesh = _storeMesh;
+    linearSolver = _linearSolver;
+    omega = _omega;
+    tol = _tol;
+    iterations = 0;
+    mesh = Create_mesh();
+    Compute_greeks();
+}
+
+// Destructor
+FDMAmerican::~FDMAmerican() {
+}
+
+FDMMesh FDMAmerican::Create_mesh() {
+    FDMMesh mesh(storeMesh ? M+1 : 0, N+1);
+    std::vector<double> U_prior(storeMesh ? 0 : N+1, 0.0);
+    std::vector<double> U_posterior(U_prior);
+    double* prior = storeMesh ? mesh.row(0).data : U_prior.data();
+    double* posterior = prior;
+
+    // The early exercise value at tau is exp(b tau) times the payoff row f(x_i); Rannacher starts from the cell
+    // averages, kept above it
+    bool rannacher = scheme == FDMScheme::CrankNicolsonRannacher;
+    std::vector<double> payoff(N+1), bound(N+1), rhs(N+1);
+    for (int i = 0; i <= N; i++){
+        payoff[i] = f(x_nodes[i]);
+        prior[i] = payoff[i];
+        if (rannacher && 0 < i && i < N) {
+            prior[i] = std::max(payoff[i], f_average((x_nodes[i-1] + x_nodes[i]) / 2, (x_nodes[i] + x_nodes[i+1]) / 2));
+        }
+    }
+
+    // a backward Euler half-step has the Crank-Nicolson matrix
+    double weight = scheme == FDMScheme::CrankNicolson || rannacher ? 0.5 : 1.0;
+    double diag = 1 + 2*weight*alpha, off = weight*alpha;
+    // Brennan-Schwartz wants the exercise region where its back substitution starts, at the high end of the
+    // unknowns: calls as they are, puts in reverse order (the matrix is the same either way)
+    std::vector<double> reversed_rhs, reversed_bound;
+    if (scheme != FDMScheme::ForwardEuler && linearSolver == FDMAmericanSolver::BrennanSchwartz) {
+        solver.factor(N-1, -off, diag, -off);
+        reversed_rhs.resize(N-1);
+        reversed_bound.resize(N-1);
+    }
+    iterations = 0;
+    double growth = 1.0, step_growth = std::exp(b * delta_Tau);  // exp(b tau), advanced one step at a time
+    double half_step_growth = std::exp(b * delta_Tau / 2);
+
+    for (int j = 1; j <= M; j++) {
+        if (storeMesh) posterior = mesh.row(j).data;
+        else if (j == 1) posterior = U_posterior.data();
+        // the Rannacher start-up steps are two backward Euler half-steps, the second from the first in place
+        int substeps = rannacher && j <= FDM_RANNACHER_STEPS ? 2 : 1;
+        for (int substep = 0; substep < substeps; substep++) {
+            const double* source = substep == 0 ? prior : posterior;
+            growth *= substeps == 2 ? half_step_growth : step_growth;
+            for (int i = 0; i <= N; i++){
+                bound[i] = growth * payoff[i];
+            }
+            // g_left and g_right, the exercise values at the ends
+            posterior[0] = bound[0];
+            posterior[N] = bound[N];
+            if (scheme == FDMScheme::ForwardEuler) {
+                heat_step(prior, posterior, N, alpha, bound.data());
+            }
+            else {
+                if (substeps == 2) {
+                    std::copy(source + 1, source + N, &rhs[1]);
+                }
+                else {
+                    heat_step(prior, rhs.data(), N, (1-weight) * alpha);
+                }
+                if (linearSolver == FDMAmericanSolver::PSOR) {
+                    // start from the last row, already above the exercise value up to the exp(b delta_Tau) growth
+                    for (int i = 1; i < N; i++){
+                        posterior[i] = std::max(source[i], bound[i]);
+                    }
+                    iterations += psor(posterior, rhs.data(), bound.data(), diag, off);
+                }
+                else {
+                    rhs[1] += off * posterior[0];
+                    rhs[N-1] += off * posterior[N];
+                    if (isPut) {
+                        std::reverse_copy(&rhs[1], &rhs[N], reversed_rhs.begin());
+                        std::reverse_copy(&bound[1], &bound[N], reversed_bound.begin());
+                        solver.solveProjected(reversed_rhs.data(), reversed_bound.data());
+                        std::reverse_copy(reversed_rhs.begin(), reversed_rhs.end(), &posterior[1]);
+                    }
+                    else {
+                        std::copy(&rhs[1], &rhs[N], &posterior[1]);
+                        solver.solveProjected(&posterior[1], &bound[1]);
+                    }
+                }
+            }
+        }
+        std::swap(prior, posterior);
+    }
+    U_final.assign(prior, prior + N+1);
+    U_previous.assign(posterior, posterior + N+1);
+    return mesh;
+}
+
+// Projected SOR sweeps on diag U_i - off (U_i-1 + U_i+1) = rhs_i, U_i >= bound_i for i = 1..N-1, with U_0 and U_N
+// fixed; returns the number of sweeps
+int FDMAmerican::psor(double* U, const double* rhs, const double* bound, double diag, double off) {
+    int sweeps = 0;
+    double change = tol + 1;
+    while (change > tol && sweeps < 10000) {
+        change = 0.0;
+        for (int i = 1; i < N; i++){
+            double gauss_seidel = (rhs[i] + off * (U[i-1] + U[i+1])) / diag;
+            double updated = std::max((1-omega) * U[i] + omega * gauss_seidel, bound[i]);
+            change = std::max(change, std::fabs(updated - U[i]));
+            U[i] = updated;
+        }
+        sweeps++;
+    }
+    return sweeps;
+}
+
+// Early exercise value at the ends of the grid
+double FDMAmerican::g_left(double Tau) {
+    if (isPut){
+        return K * std::exp(a*x_left + b*Tau) * (1 - std::exp(x_left));
+    }
+    else{
+        return 0.0;
+    }
+}
+
+double FDMAmerican::g_right(double Tau) {
+    if (isPut){
+        return 0.0;
+    }
+    else{
+        return K * std::exp(a*x_right + b*Tau) * (std::exp(x_right) - 1);
+    }
+}
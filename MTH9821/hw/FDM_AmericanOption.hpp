@@ -0,0 +1,38 @@
+#ifndef FDM_AMERICANOPTION_HPP
+#define FDM_AMERICANOPTION_HPP
+
+#include "FDM_EuropeanOption.hpp"
+#include <vector>
+
+// Linear complementarity solver of the implicit American steps
+enum class FDMAmericanSolver {
+    PSOR,            // projected successive over-relaxation, iterated to tol
+    BrennanSchwartz  // direct: the Thomas algorithm with the early exercise projection in its back substitution
+};
+
+// American option on the heat equation grid of FDMEuropean: every new row is kept above the early exercise value
+//   K exp(a x + b tau) max(1 - e^x, 0) for puts, K exp(a x + b tau) max(e^x - 1, 0) for calls
+// by projection (forward Euler) or by the linear complementarity solver (backward Euler, Crank-Nicolson).
+class FDMAmerican : public FDMEuropean {
+public:
+    FDMAmericanSolver linearSolver;
+    double omega;     // PSOR over-relaxation, in (0, 2)
+    double tol;       // PSOR stops when no node moves by more than tol in a sweep
+    long iterations;  // PSOR sweeps, summed over the time steps
+
+    // Constructor
+    FDMAmerican(const EuropeanOption& _option, double _M, double _alpha_temp, bool _isPut, FDMScheme _scheme = FDMScheme::ForwardEuler,
+                FDMAmericanSolver _linearSolver = FDMAmericanSolver::PSOR, double _omega = 1.2, double _tol = 1e-6, bool _storeMesh = true);
+
+    // Destructor
+    ~FDMAmerican();
+
+    FDMMesh Create_mesh();
+    double g_left(double Tau);
+    double g_right(double Tau);
+
+private:
+    int psor(double* U, const double* rhs, const double* bound, double diag, double off);
+};
+
+#endif // FDM_AMERICANOPTION_HPP
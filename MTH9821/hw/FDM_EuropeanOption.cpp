@@ -1,4 +1,7 @@
 #include "FDM_EuropeanOption.hpp"
+#include "FDM_Kernel.hpp"
+#include <algorithm>
+#include <cmath>
 
 FDMEuropean::FDMEuropean() {
     t = 0.0;      // Current time
@@ -11,19 +14,14 @@ FDMEuropean::FDMEuropean() {
     M = 4;      // meshsize
     alpha_temp = 0.45;
     isPut = true;
-    a = (r-q)/(sigma*sigma) - 0.5;
-    b = ((r-q)/(sigma*sigma) + 0.5) * ((r-q)/(sigma*sigma) + 0.5) + 2*q/(sigma*sigma);
-    x_left = std::log(S / K) + (r - q - 0.5 * sigma * sigma) * T - 3 * sigma * std::sqrt(T);
-    x_right = std::log(S / K) + (r - q - 0.5 * sigma * sigma) * T + 3 * sigma * std::sqrt(T);
-    Tau_final = 0.5 * T * sigma * sigma;
-    delta_Tau = std::sqrt(Tau_final/M);
-    N = std::floor((x_right-x_left)/std::sqrt(delta_Tau/alpha_temp));
-    delta_x = (x_right-x_left)/N;
-    alpha = delta_Tau/(delta_x * delta_x);
+    Setup_grid();
+    scheme = FDMScheme::ForwardEuler;
+    storeMesh = true;
+    price = delta = gamma = theta = 0.0;
 }
 
 // Constructor implementation
-FDMEuropean::FDMEuropean(const EuropeanOption& _option, double _M, double _alpha_temp, bool _isPut) {
+FDMEuropean::FDMEuropean(const EuropeanOption& _option, double _M, double _alpha_temp, bool _isPut, FDMScheme _scheme, bool _storeMesh) {
     t = _option.t;      // Current time
     S = _option.S;      // Current stock price
     K = _option.K;      // Strike price
@@ -34,53 +32,238 @@ FDMEuropean::FDMEuropean(const EuropeanOption& _option, double _M, double _alpha
     M = _M;      // meshsize
     alpha_temp = _alpha_temp;
     isPut = _isPut;
+    Setup_grid();
+    scheme = _scheme;
+    storeMesh = _storeMesh;
+    mesh = Create_mesh();
+    Compute_greeks();
+}
+
+// Constructor on a given grid: N intervals over [_x_left, _x_right] and M time steps
+FDMEuropean::FDMEuropean(const EuropeanOption& _option, double _M, int _N, double _x_left, double _x_right, bool _isPut, FDMScheme _scheme,
+                         bool _storeMesh, double _clustering) {
+    t = _option.t;      // Current time
+    S = _option.S;      // Current stock price
+    K = _option.K;      // Strike price
+    T = _option.T;      // Time to maturity
+    sigma = _option.sigma;  // Volatility of the stock
+    r = _option.r;      // Risk-free rate
+    q = _option.q;      // Dividend yield
+    M = _M;      // meshsize
+    isPut = _isPut;
     a = (r-q)/(sigma*sigma) - 0.5;
     b = ((r-q)/(sigma*sigma) + 0.5) * ((r-q)/(sigma*sigma) + 0.5) + 2*q/(sigma*sigma);
-    x_left = std::log(S / K) + (r - q - 0.5 * sigma * sigma) * T - 3 * sigma * std::sqrt(T);
-    x_right = std::log(S / K) + (r - q - 0.5 * sigma * sigma) * T + 3 * sigma * std::sqrt(T);
+    x_left = _x_left;
+    x_right = _x_right;
     Tau_final = 0.5 * T * sigma * sigma;
-    delta_Tau = std::sqrt(Tau_final/M);
-    N = std::floor((x_right-x_left)/std::sqrt(delta_Tau/alpha_temp));
+    delta_Tau = Tau_final/M;
+    N = _N;
     delta_x = (x_right-x_left)/N;
     alpha = delta_Tau/(delta_x * delta_x);
+    clustering = _clustering;
+    x_nodes.resize(N+1);
+    if (clustering > 0) {
+        // centred on the spot when it is on the domain, with delta_xi shortened so the strike is a node as well
+        double x_c = x_left < std::log(S / K) && std::log(S / K) < x_right ? std::log(S / K) : 0.0;
+        double xi_left = std::asinh((x_left - x_c) / clustering), xi_right = std::asinh((x_right - x_c) / clustering);
+        double delta_xi = (xi_right - xi_left) / N;
+        // a strike within one delta_xi of the spot (or off the grid) is left between nodes: the spot node wins
+        double xi_strike = std::asinh(-x_c / clustering);
+        bool strike_node = x_left < 0 && 0 < x_right && std::fabs(xi_strike) >= delta_xi;
+        if (strike_node)
+            delta_xi = std::fabs(xi_strike) / std::ceil(std::fabs(xi_strike) / delta_xi - 1e-9);
+        int n_left = std::ceil(-xi_left / delta_xi - 1e-9), n_right = std::ceil(xi_right / delta_xi - 1e-9);
+        N = n_left + n_right;
+        x_nodes.resize(N+1);
+        for (int i = 0; i <= N; i++) x_nodes[i] = x_c + clustering * std::sinh((i - n_left) * delta_xi);
+        x_nodes[n_left] = x_c;
+        if (strike_node) x_nodes[n_left + (int)std::round(xi_strike / delta_xi)] = 0.0;
+        x_left = x_nodes[0];
+        x_right = x_nodes[N];
+        delta_x = (x_right-x_left)/N;
+        alpha = 0.0;
+        for (int i = 1; i < N; i++) {
+            double h_minus = x_nodes[i] - x_nodes[i-1], h_plus = x_nodes[i+1] - x_nodes[i];
+            alpha = std::max(alpha, delta_Tau / (h_minus * h_plus));
+        }
+    }
+    else {
+        for (int i = 0; i <= N; i++) x_nodes[i] = x_left + i * delta_x;
+    }
+    alpha_temp = alpha;
+    scheme = _scheme;
+    storeMesh = _storeMesh;
     mesh = Create_mesh();
+    Compute_greeks();
 }
 
 // Destructor
 FDMEuropean::~FDMEuropean() {
 }
 
-std::vector<std::vector<double>> FDMEuropean::Create_mesh() {
-    //double x_left = std::log(S / K) + (r - q - 0.5 * sigma * sigma) * T - 3 * sigma * std::sqrt(T);
-    //double x_right = std::log(S / K) + (r - q - 0.5 * sigma * sigma) * T + 3 * sigma * std::sqrt(T);
-    
-    std::vector<std::vector<double>> mesh(M+1, std::vector<double>(N+1, 0.0));
-    std::vector<double> U_prior(N+1, 0.0);
-    std::vector<double> x_vec(N+1, 0.0);
+// Heat equation variables and grid of the option parameters
+void FDMEuropean::Setup_grid() {
+    a = (r-q)/(sigma*sigma) - 0.5;
+    b = ((r-q)/(sigma*sigma) + 0.5) * ((r-q)/(sigma*sigma) + 0.5) + 2*q/(sigma*sigma);
+    x_left = std::log(S / K) + (r - q - 0.5 * sigma * sigma) * T - 3 * sigma * std::sqrt(T);
+    x_right = std::log(S / K) + (r - q - 0.5 * sigma * sigma) * T + 3 * sigma * std::sqrt(T);
+    Tau_final = 0.5 * T * sigma * sigma;
+    delta_Tau = Tau_final/M;
+    N = std::floor((x_right-x_left)/std::sqrt(delta_Tau/alpha_temp));
+    delta_x = (x_right-x_left)/N;
+    alpha = delta_Tau/(delta_x * delta_x);
+    clustering = 0.0;
+    x_nodes.resize(N+1);
+    for (int i = 0; i <= N; i++) x_nodes[i] = x_left + i * delta_x;
+}
 
-    // Setup initial state
+FDMMesh FDMEuropean::Create_mesh() {
+    FDMMesh mesh(storeMesh ? M+1 : 0, N+1);
+    // price-only mode: two rows that trade places every step
+    std::vector<double> U_prior(storeMesh ? 0 : N+1, 0.0);
+    std::vector<double> U_posterior(U_prior);
+    double* prior = storeMesh ? mesh.row(0).data : U_prior.data();
+    double* posterior = prior;
+
+    // Setup initial state; Rannacher starts from the payoff averaged over each node's cell, between the midpoints
+    bool rannacher = scheme == FDMScheme::CrankNicolsonRannacher;
     for (int i = 0; i <= N; i++){
-        x_vec[i] = x_left + i * delta_x;
-        U_prior[i] = f(x_vec[i]);
+        prior[i] = rannacher && 0 < i && i < N ? f_average((x_nodes[i-1] + x_nodes[i]) / 2, (x_nodes[i] + x_nodes[i+1]) / 2)
+                                               : f(x_nodes[i]);
     }
-    mesh[0] = U_prior;
-    std::vector<double> U_posterior(N+1, 0.0);
+
+    // Implicit schemes solve (1 + 2 weight alpha) U_i - weight alpha (U_i-1 + U_i+1) = rhs_i on the interior nodes,
+    // weight = 1 for backward Euler and 1/2 for Crank-Nicolson; the matrix is the same every step, and a backward
+    // Euler half-step has the Crank-Nicolson one
+    double weight = scheme == FDMScheme::CrankNicolson || rannacher ? 0.5 : 1.0;
+    // Non-uniform grid: u_xx from the three-point stencil on spacings h- and h+, so alpha becomes
+    // lower_i = 2 delta_Tau / (h- (h- + h+)) towards i-1 and upper_i = 2 delta_Tau / (h+ (h- + h+)) towards i+1
+    bool uniform = clustering <= 0;
+    std::vector<double> lower, upper, explicit_lower, explicit_upper;
+    if (!uniform) {
+        lower.assign(N+1, 0.0);
+        upper.assign(N+1, 0.0);
+        for (int i = 1; i < N; i++) {
+            double h_minus = x_nodes[i] - x_nodes[i-1], h_plus = x_nodes[i+1] - x_nodes[i];
+            lower[i] = 2 * delta_Tau / (h_minus * (h_minus + h_plus));
+            upper[i] = 2 * delta_Tau / (h_plus * (h_minus + h_plus));
+        }
+        double explicit_weight = scheme == FDMScheme::ForwardEuler ? 1.0 : 1 - weight;
+        explicit_lower.resize(N+1);
+        explicit_upper.resize(N+1);
+        for (int i = 0; i <= N; i++) {
+            explicit_lower[i] = explicit_weight * lower[i];
+            explicit_upper[i] = explicit_weight * upper[i];
+        }
+    }
+    if (scheme != FDMScheme::ForwardEuler) {
+        if (uniform) {
+            solver.factor(N-1, -weight*alpha, 1 + 2*weight*alpha, -weight*alpha);
+        }
+        else {
+            // unknown k is node k + 1
+            std::vector<double> l(N-1), d(N-1), u(N-1);
+            for (int k = 0; k < N-1; k++) {
+                l[k] = -weight * lower[k+1];
+                d[k] = 1 + weight * (lower[k+1] + upper[k+1]);
+                u[k] = -weight * upper[k+1];
+            }
+            solver.factor(N-1, l.data(), d.data(), u.data());
+        }
+    }
+
+    // The boundary values are sums of exponentials in tau, K exp(a x + b tau) (exp(-2 r tau / sigma^2) - exp(x - 2 q tau / sigma^2))
+    // for puts at x_left, so they are advanced by their one-step factors instead of calling exp every step
+    double discount_r = 1.0, discount_q = 1.0;  // exp((b - 2r/sigma^2) tau), exp((b - 2q/sigma^2) tau)
+    double step_r = std::exp((b - 2*r/(sigma*sigma)) * delta_Tau), step_q = std::exp((b - 2*q/(sigma*sigma)) * delta_Tau);
+    double half_step_r = std::exp((b - 2*r/(sigma*sigma)) * delta_Tau / 2), half_step_q = std::exp((b - 2*q/(sigma*sigma)) * delta_Tau / 2);
+    double scale_left = K * std::exp(a*x_left), scale_right = K * std::exp(a*x_right);
+    double spot_left = std::exp(x_left), spot_right = std::exp(x_right);
+    auto advance_boundaries = [&](double* U, double factor_r, double factor_q) {
+        discount_r *= factor_r;
+        discount_q *= factor_q;
+        U[0] = isPut ? scale_left * (discount_r - spot_left * discount_q) : 0.0;
+        U[N] = isPut ? 0.0 : scale_right * (spot_right * discount_q - discount_r);
+    };
+    // weights of the end nodes towards the boundary values
+    double weight_left = uniform ? alpha : lower[1], weight_right = uniform ? alpha : upper[N-1];
 
     // Generate next row of mesh
+    double explicit_alpha = (1-weight) * alpha;
     for (int j = 1; j <= M; j++) {
-        for (int i = 1; i < N; i++){
-            U_posterior[i] = alpha * U_prior[i-1] + (1-2*alpha) * U_prior[i] + alpha * U_prior[i+1];
-        U_posterior[0] = g_left(j*delta_Tau); // Not entirely sure if j*delta_Tau is correct here for input to g_left
-        U_posterior[N] = g_right(j*delta_Tau); // Not entirely sure if j*delta_Tau is correct here for input to g_right
-        // U_posterior[0] = alpha * g_left(j*delta_Tau) + (1-2*alpha) * U_prior[0] + alpha * U_prior[1]; // Not entirely sure if j*delta_Tau is correct here for input to g_left
-        // U_posterior[N] = alpha * U_prior[N-1] + (1-2*alpha) * U_prior[N] + alpha * g_right(j*delta_Tau); // Not entirely sure if j*delta_Tau is correct here for input to g_right
-        mesh[j] = U_posterior;
-        U_prior = U_posterior;
+        if (storeMesh) posterior = mesh.row(j).data;
+        else if (j == 1) posterior = U_posterior.data();
+        if (rannacher && j <= FDM_RANNACHER_STEPS) {
+            std::copy(prior + 1, prior + N, posterior + 1);
+            for (int half = 0; half < 2; half++) {
+                advance_boundaries(posterior, half_step_r, half_step_q);
+                posterior[1] += weight * weight_left * posterior[0];
+                posterior[N-1] += weight * weight_right * posterior[N];
+                solver.solve(&posterior[1]);
+            }
+            std::swap(prior, posterior);
+            continue;
+        }
+        advance_boundaries(posterior, step_r, step_q);
+        if (!uniform) {
+            heat_step_variable(prior, posterior, N, explicit_lower.data(), explicit_upper.data());
+        }
+        else {
+            heat_step(prior, posterior, N, scheme == FDMScheme::ForwardEuler ? alpha : explicit_alpha);
         }
+        if (scheme != FDMScheme::ForwardEuler) {
+            // explicit part of the step above, then the boundary values at the new time moved to the right-hand side
+            posterior[1] += weight * weight_left * posterior[0];
+            posterior[N-1] += weight * weight_right * posterior[N];
+            solver.solve(&posterior[1]);
+        }
+        std::swap(prior, posterior);
     }
+    // prior holds row M, posterior row M-1 (row 0 as well when M = 0)
+    U_final.assign(prior, prior + N+1);
+    U_previous.assign(posterior, posterior + N+1);
     return mesh;
 }
 
+// Price and Greeks at S from the last two rows
+void FDMEuropean::Compute_greeks() {
+    std::vector<double> values = Greeks_at(S);
+    price = values[0];
+    delta = values[1];
+    gamma = values[2];
+    theta = values[3];
+}
+
+// Price, delta, gamma and theta at any spot S_compute for the strike K of the grid, with V = exp(-a x - b tau) u at
+// the nodes S_i = K e^(x_i): price by linear interpolation in S between the nodes i, i+1 around x = log(S_compute/K),
+// delta and gamma from the quadratics through i-1, i, i+1 and through i, i+1, i+2, interpolated the same way (second
+// order also when S_compute is a node), theta from the price one time step earlier, 2 delta_Tau / sigma^2 later in t
+std::vector<double> FDMEuropean::Greeks_at(double S_compute) const {
+    double x_compute = std::log(S_compute / K);
+    int i = std::upper_bound(x_nodes.begin(), x_nodes.end(), x_compute) - x_nodes.begin() - 1;
+    i = std::max(1, std::min(i, N - 2));
+    double S_node[4], V_node[4], V_earlier[2];
+    for (int k = 0; k < 4; k++) {
+        double x = x_nodes[i - 1 + k];
+        S_node[k] = K * std::exp(x);
+        V_node[k] = std::exp(-a*x - b*Tau_final) * U_final[i - 1 + k];
+        if (k == 1 || k == 2) V_earlier[k - 1] = std::exp(-a*x - b*(Tau_final - delta_Tau)) * U_previous[i - 1 + k];
+    }
+    // nodes i and i+1 are S_node[1] and S_node[2]
+    double w = (S_compute - S_node[1]) / (S_node[2] - S_node[1]);
+    double value = (1 - w) * V_node[1] + w * V_node[2];
+    double h[3], D[3];  // spacings and divided differences of the three intervals
+    for (int k = 0; k < 3; k++) {
+        h[k] = S_node[k+1] - S_node[k];
+        D[k] = (V_node[k+1] - V_node[k]) / h[k];
+    }
+    double slope = (1 - w) * (h[1] * D[0] + h[0] * D[1]) / (h[0] + h[1]) + w * (h[2] * D[1] + h[1] * D[2]) / (h[1] + h[2]);
+    double convexity = (1 - w) * 2 * (D[1] - D[0]) / (h[0] + h[1]) + w * 2 * (D[2] - D[1]) / (h[1] + h[2]);
+    double delta_t = 2 * delta_Tau / (sigma * sigma);
+    double value_earlier = (1 - w) * V_earlier[0] + w * V_earlier[1];
+    return {value, slope, convexity, (value_earlier - value) / delta_t};
+}
+
 double FDMEuropean::f(double x) {
     if (isPut){
         return K * std::exp(a*x) * std::max(1-std::exp(x),0.0);
@@ -90,6 +273,17 @@ double FDMEuropean::f(double x) {
     }
 }
 
+// Mean of f over [x_low, x_high], from the antiderivatives of K e^(a x) and K e^((a+1) x)
+double FDMEuropean::f_average(double x_low, double x_high) {
+    auto integral = [](double c, double lo, double hi) {
+        return c == 0.0 ? hi - lo : (std::exp(c*hi) - std::exp(c*lo)) / c;
+    };
+    double lo = isPut ? x_low : std::max(x_low, 0.0), hi = isPut ? std::min(x_high, 0.0) : x_high;
+    if (lo >= hi) return 0.0;
+    double sum = isPut ? integral(a, lo, hi) - integral(a+1, lo, hi) : integral(a+1, lo, hi) - integral(a, lo, hi);
+    return K * sum / (x_high - x_low);
+}
+
 double FDMEuropean::g_left(double Tau) {
     if (isPut){
         return K * std::exp(a*x_left + b*Tau) * (std::exp(-2*r*Tau/(sigma*sigma)) - std::exp(x_left-2*q*Tau/(sigma*sigma)));
@@ -104,6 +298,6 @@ double FDMEuropean::g_right(double Tau) {
         return 0.0;
     }
     else{
-        return K * std::exp(a*x_right + b*Tau) * (std::exp(x_right-2*r*Tau/(sigma*sigma)) - std::exp(-2*r*Tau/(sigma*sigma)));
+        return K * std::exp(a*x_right + b*Tau) * (std::exp(x_right-2*q*Tau/(sigma*sigma)) - std::exp(-2*r*Tau/(sigma*sigma)));
     }
 }
\ No newline at end of file
@@ -2,8 +2,22 @@
 #define FDM_EUROOPTION_HPP
 
 #include "EuropeanOption.hpp"
+#include "FDM_Mesh.hpp"
+#include "Tridiagonal.hpp"
 #include <vector>
 
+// Time stepping of the heat equation u_tau = u_xx
+enum class FDMScheme {
+    ForwardEuler,   // explicit, stable for alpha <= 1/2
+    BackwardEuler,  // implicit, first order in time, any alpha
+    CrankNicolson,  // implicit, second order in time, any alpha
+    // Crank-Nicolson from the cell-averaged payoff, its first FDM_RANNACHER_STEPS steps taken as two backward Euler
+    // half-steps each to damp the payoff kink, which plain Crank-Nicolson carries along as an oscillation
+    CrankNicolsonRannacher
+};
+
+const int FDM_RANNACHER_STEPS = 2;
+
 class FDMEuropean {
 public:
     // Member variable to store the EuropeanOption object
@@ -25,20 +39,43 @@ public:
     double Tau_final;
     double delta_Tau;
     int N;
-    double delta_x;
-    double alpha;
-    std::vector<std::vector<double>> mesh;
+    double delta_x;                // mean spacing on a non-uniform grid
+    double alpha;                  // largest half sum of the stencil weights on a non-uniform grid (forward Euler needs <= 1/2)
+    double clustering;             // 0: uniform grid; > 0: x_i = x_c + clustering * sinh(xi_i), xi_i uniform
+    std::vector<double> x_nodes;   // x_0 = x_left .. x_N = x_right
+    FDMScheme scheme;
+    TridiagonalSolver solver;  // implicit schemes: the factored time step
+    bool storeMesh;            // false: price-only mode, mesh stays empty and only the two rows below are kept
+    FDMMesh mesh;                    // row j at tau = j * delta_Tau, column i at x = x_nodes[i]
+    std::vector<double> U_final;     // row M, tau = Tau_final
+    std::vector<double> U_previous;  // row M-1, for theta
+    // at S and t, from U_final and U_previous
+    double price;
+    double delta;
+    double gamma;
+    double theta;
 
     // Constructor
     FDMEuropean();
-    FDMEuropean(const EuropeanOption& _option, double _M, double _alpha_temp, bool _isPut);
+    FDMEuropean(const EuropeanOption& _option, double _M, double _alpha_temp, bool _isPut, FDMScheme _scheme = FDMScheme::ForwardEuler,
+                bool _storeMesh = true);
+    // With _clustering > 0 the nodes are stretched by sinh around x_c, the spot ln(S/K) (the strike x = 0 when the spot
+    // is off the grid): spacing about _clustering * delta_xi at x_c, growing exponentially away from it. x_c and the
+    // strike are made nodes, so N may grow and the domain widen by a step; a strike less than one delta_xi from the
+    // spot stays between nodes, the payoff kink then off the grid.
+    FDMEuropean(const EuropeanOption& _option, double _M, int _N, double _x_left, double _x_right, bool _isPut,
+                FDMScheme _scheme = FDMScheme::ForwardEuler, bool _storeMesh = true, double _clustering = 0.0);
 
     // Destructor
     ~FDMEuropean();
 
     // 
-    std::vector<std::vector<double>> Create_mesh();
+    void Setup_grid();
+    FDMMesh Create_mesh();
+    void Compute_greeks();
+    std::vector<double> Greeks_at(double S_compute) const;  // price, delta, gamma, theta
     double f(double x);
+    double f_average(double x_low, double x_high);
     double g_left(double Tau);
     double g_right(double Tau);
 };
@@ -0,0 +1,119 @@
+#ifndef FDM_KERNEL_HPP
+#define FDM_KERNEL_HPP
+
+#include <algorithm>
+
+// Explicit heat equation step on the interior nodes i = 1..n-1,
+//   posterior[i] = alpha * prior[i-1] + (1 - 2 alpha) * prior[i] + alpha * prior[i+1],
+// optionally raised to bound[i] (American). The boundary nodes 0 and n are left to the caller.
+// The vector kernels keep the scalar order of operations and finish the row with a masked partial vector, and
+// contraction into FMAs is off in all of them, so every instruction set gives the same bits.
+#if defined(__GNUC__) && !defined(__clang__)
+#define FDM_NO_FMA __attribute__((optimize("fp-contract=off")))
+#else
+#define FDM_NO_FMA
+#endif
+
+FDM_NO_FMA inline void heat_step_scalar(const double* prior, double* posterior, int n, double alpha, const double* bound) {
+    double beta = 1 - 2*alpha;
+    for (int i = 1; i < n; i++) {
+        double value = alpha * prior[i-1] + beta * prior[i] + alpha * prior[i+1];
+        posterior[i] = bound ? std::max(value, bound[i]) : value;
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FDM_X86_SIMD
+#include <immintrin.h>
+
+FDM_NO_FMA __attribute__((target("avx2"))) inline __m256d heat_stencil_avx2(__m256d left, __m256d mid, __m256d right, __m256d a, __m256d c) {
+    return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a, left), _mm256_mul_pd(c, mid)), _mm256_mul_pd(a, right));
+}
+
+FDM_NO_FMA __attribute__((target("avx2"))) inline void heat_step_avx2(const double* prior, double* posterior, int n, double alpha, const double* bound) {
+    const __m256d a = _mm256_set1_pd(alpha), c = _mm256_set1_pd(1 - 2*alpha);
+    int i = 1;
+    for (; i + 4 <= n; i += 4) {
+        __m256d y = heat_stencil_avx2(_mm256_loadu_pd(prior + i - 1), _mm256_loadu_pd(prior + i), _mm256_loadu_pd(prior + i + 1), a, c);
+        if (bound) y = _mm256_max_pd(y, _mm256_loadu_pd(bound + i));
+        _mm256_storeu_pd(posterior + i, y);
+    }
+    if (i < n) {
+        __m256i m = _mm256_cmpgt_epi64(_mm256_set1_epi64x(n - i), _mm256_set_epi64x(3, 2, 1, 0));
+        __m256d y = heat_stencil_avx2(_mm256_maskload_pd(prior + i - 1, m), _mm256_maskload_pd(prior + i, m), _mm256_maskload_pd(prior + i + 1, m), a, c);
+        if (bound) y = _mm256_max_pd(y, _mm256_maskload_pd(bound + i, m));
+        _mm256_maskstore_pd(posterior + i, m, y);
+    }
+}
+
+FDM_NO_FMA __attribute__((target("avx512f"))) inline __m512d heat_stencil_avx512(__m512d left, __m512d mid, __m512d right, __m512d a, __m512d c) {
+    return _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(a, left), _mm512_mul_pd(c, mid)), _mm512_mul_pd(a, right));
+}
+
+// the projections use _mm512_mask_max_pd with an explicit source: _mm512_max_pd merges into an undefined vector, which -Wall flags
+FDM_NO_FMA __attribute__((target("avx512f"))) inline void heat_step_avx512(const double* prior, double* posterior, int n, double alpha, const double* bound) {
+    const __m512d a = _mm512_set1_pd(alpha), c = _mm512_set1_pd(1 - 2*alpha);
+    int i = 1;
+    for (; i + 8 <= n; i += 8) {
+        __m512d y = heat_stencil_avx512(_mm512_loadu_pd(prior + i - 1), _mm512_loadu_pd(prior + i), _mm512_loadu_pd(prior + i + 1), a, c);
+        if (bound) y = _mm512_mask_max_pd(y, 0xFF, y, _mm512_loadu_pd(bound + i));
+        _mm512_storeu_pd(posterior + i, y);
+    }
+    if (i < n) {
+        __mmask8 m = __mmask8((1u << (n - i)) - 1);
+        __m512d y = heat_stencil_avx512(_mm512_maskz_loadu_pd(m, prior + i - 1), _mm512_maskz_loadu_pd(m, prior + i), _mm512_maskz_loadu_pd(m, prior + i + 1), a, c);
+        if (bound) y = _mm512_mask_max_pd(y, m, y, _mm512_maskz_loadu_pd(m, bound + i));
+        _mm512_mask_storeu_pd(posterior + i, m, y);
+    }
+}
+#endif
+
+// Explicit step on a non-uniform grid, with the weights of each node towards its neighbours:
+//   posterior[i] = lower[i] * prior[i-1] + (1 - lower[i] - upper[i]) * prior[i] + upper[i] * prior[i+1]
+FDM_NO_FMA inline void heat_step_variable(const double* prior, double* posterior, int n, const double* lower, const double* upper) {
+    for (int i = 1; i < n; i++) {
+        posterior[i] = lower[i] * prior[i-1] + (1 - lower[i] - upper[i]) * prior[i] + upper[i] * prior[i+1];
+    }
+}
+
+// Instruction set of heat_step, detected once at first use
+enum FDMSimdLevel {
+    FDM_SIMD_SCALAR = 0,
+    FDM_SIMD_AVX2 = 1,
+    FDM_SIMD_AVX512 = 2
+};
+
+inline FDMSimdLevel detect_fdm_simd_level() {
+#ifdef FDM_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return FDM_SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2")) return FDM_SIMD_AVX2;
+#endif
+    return FDM_SIMD_SCALAR;
+}
+
+inline FDMSimdLevel& active_fdm_simd_level() {
+    static FDMSimdLevel level = detect_fdm_simd_level();
+    return level;
+}
+
+// Force a lower instruction set (e.g. to benchmark against the scalar loop), capped at what the CPU supports
+inline void set_fdm_simd_level(FDMSimdLevel level) {
+    active_fdm_simd_level() = std::min(level, detect_fdm_simd_level());
+}
+
+inline void heat_step(const double* prior, double* posterior, int n, double alpha, const double* bound = nullptr) {
+#ifdef FDM_X86_SIMD
+    switch (active_fdm_simd_level()) {
+    case FDM_SIMD_AVX512:
+        return heat_step_avx512(prior, posterior, n, alpha, bound);
+    case FDM_SIMD_AVX2:
+        return heat_step_avx2(prior, posterior, n, alpha, bound);
+    default:
+        break;
+    }
+#endif
+    heat_step_scalar(prior, posterior, n, alpha, bound);
+}
+
+#endif // FDM_KERNEL_HPP
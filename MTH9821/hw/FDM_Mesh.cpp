@@ -0,0 +1,8 @@
+#include "FDM_Mesh.hpp"
+
+FDMMesh::FDMMesh() : n_rows(0), n_cols(0), row_stride(0) {
+}
+
+FDMMesh::FDMMesh(int _rows, int _cols) : n_rows(_rows), n_cols(_cols), row_stride((_cols + 7) / 8 * 8) {
+    values.assign(static_cast<std::size_t>(n_rows) * row_stride, 0.0);
+}
@@ -0,0 +1,81 @@
+#ifndef FDM_MESH_HPP
+#define FDM_MESH_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Allocator returning 64 byte (cache line) aligned blocks
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* ptr, std::size_t) noexcept {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+};
+
+template <typename T, typename U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return true; }
+template <typename T, typename U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return false; }
+
+// Non-owning view of size entries stride apart: a row of the mesh (stride 1) or a column (stride = row stride)
+template <typename T>
+struct MeshView {
+    T* data;
+    int size;
+    int stride;
+
+    T& operator[](int i) const { return data[static_cast<std::ptrdiff_t>(i) * stride]; }
+    std::vector<double> copy() const {
+        std::vector<double> values(size);
+        for (int i = 0; i < size; i++) values[i] = (*this)[i];
+        return values;
+    }
+};
+
+// Time x space grid of node values in one row-major allocation. Rows are padded to a multiple of 8 doubles,
+// so that every row starts on a cache line.
+class FDMMesh {
+public:
+    // Constructor
+    FDMMesh();
+    FDMMesh(int _rows, int _cols);
+
+    int rows() const { return n_rows; }
+    int cols() const { return n_cols; }
+    int stride() const { return row_stride; }
+    bool empty() const { return n_rows == 0; }
+
+    double& operator()(int j, int i) { return values[static_cast<std::size_t>(j) * row_stride + i]; }
+    double operator()(int j, int i) const { return values[static_cast<std::size_t>(j) * row_stride + i]; }
+
+    double* data() { return values.data(); }
+    const double* data() const { return values.data(); }
+
+    MeshView<double> row(int j) { return {data() + static_cast<std::size_t>(j) * row_stride, n_cols, 1}; }
+    MeshView<const double> row(int j) const { return {data() + static_cast<std::size_t>(j) * row_stride, n_cols, 1}; }
+    MeshView<double> column(int i) { return {data() + i, n_rows, row_stride}; }
+    MeshView<const double> column(int i) const { return {data() + i, n_rows, row_stride}; }
+
+private:
+    int n_rows;
+    int n_cols;
+    int row_stride;
+    std::vector<double, AlignedAllocator<double>> values;
+};
+
+#endif // FDM_MESH_HPP
@@ -0,0 +1,47 @@
+#include "FDM_Richardson.hpp"
+#include <chrono>
+#include <cmath>
+
+FDMRichardson::FDMRichardson(const EuropeanOption& _option, double _M0, double _alpha_temp, bool _isPut, FDMScheme _scheme, double _width) {
+    option = _option;
+    isPut = _isPut;
+    scheme = _scheme;
+    M0 = _M0;
+    // the domain and spacing FDMEuropean would use
+    double x_compute = std::log(option.S / option.K);
+    double sigma = option.sigma, T = option.T;
+    double center = x_compute + (option.r - option.q - 0.5 * sigma * sigma) * T;
+    double Tau_final = 0.5 * T * sigma * sigma;
+    double delta_x = std::sqrt(Tau_final / M0 / _alpha_temp);
+    // shrink delta_x until it divides the distance from the spot to the strike
+    if (x_compute != 0.0) {
+        delta_x = std::fabs(x_compute) / std::ceil(std::fabs(x_compute) / delta_x);
+    }
+    // whole number of intervals from the spot to each end, covering at least the +-width sigma sqrt(T) span
+    int n_left = std::ceil((x_compute - (center - _width * sigma * std::sqrt(T))) / delta_x);
+    int n_right = std::ceil((center + _width * sigma * std::sqrt(T) - x_compute) / delta_x);
+    x_left = x_compute - n_left * delta_x;
+    x_right = x_compute + n_right * delta_x;
+    N0 = n_left + n_right;
+    // back to the requested alpha on the aligned spacing (forward Euler is unstable above 1/2)
+    M0 = std::ceil(Tau_final / (_alpha_temp * delta_x * delta_x));
+}
+
+void FDMRichardson::Add_level() {
+    int k = prices.size();
+    int N = N0 << k;
+    double M = M0 * std::pow(scheme == FDMScheme::ForwardEuler || scheme == FDMScheme::BackwardEuler ? 4.0 : 2.0, k);
+    auto start = std::chrono::steady_clock::now();
+    FDMEuropean FDM(option, M, N, x_left, x_right, isPut, scheme, false);
+    auto stop = std::chrono::steady_clock::now();
+    milliseconds.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    prices.push_back(FDM.price);
+
+    // error c_1 h^2 + c_2 h^4 + ...: the j-th column cancels the h^(2j) term
+    std::vector<double> row{FDM.price};
+    for (int j = 1; j <= k; j++) {
+        double factor = std::pow(4.0, j);
+        row.push_back(row[j-1] + (row[j-1] - table[k-1][j-1]) / (factor - 1));
+    }
+    table.push_back(row);
+}
@@ -0,0 +1,37 @@
+#ifndef FDM_RICHARDSON_HPP
+#define FDM_RICHARDSON_HPP
+
+#include "FDM_EuropeanOption.hpp"
+#include <vector>
+
+// Richardson extrapolation of FDMEuropean prices over grids refined by halving delta_x: M grows 4x per level for
+// forward and backward Euler (delta_Tau ~ delta_x^2, fixed alpha) and 2x for Crank-Nicolson (delta_Tau ~ delta_x),
+// so the error expands in even powers of delta_x and each column of the table removes one of them.
+// All levels share x_left and x_right, chosen so that both the spot x = log(S/K) and the strike x = 0 are nodes:
+// the price is read off a node without interpolation, and the payoff kink sits on a node of every grid.
+class FDMRichardson {
+public:
+    EuropeanOption option;
+    bool isPut;
+    FDMScheme scheme;
+    double M0;      // time steps of the coarsest grid
+    int N0;         // intervals of the coarsest grid
+    double x_left;
+    double x_right;
+    std::vector<double> prices;               // at the spot node, one per level
+    std::vector<double> milliseconds;         // solve time of each level
+    std::vector<std::vector<double>> table;   // table[k][j]: j extrapolations ending at level k
+
+    // Constructor: the coarsest grid as FDMEuropean would build it over +-_width standard deviations, then aligned,
+    // which may refine delta_x and raise M0 to keep alpha at _alpha_temp. The truncated domain bounds the accuracy
+    // the table can reach: about 5e-8 at the default 3 standard deviations for the put of main.cpp.
+    FDMRichardson(const EuropeanOption& _option, double _M0, double _alpha_temp, bool _isPut, FDMScheme _scheme = FDMScheme::ForwardEuler,
+                  double _width = 3.0);
+
+    // Solves the next finer grid and extends the table; the coarser levels are kept
+    void Add_level();
+    int levels() const { return prices.size(); }
+    double price() const { return table.back().back(); }
+};
+
+#endif // FDM_RICHARDSON_HPP
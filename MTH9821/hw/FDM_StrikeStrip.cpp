@@ -0,0 +1,31 @@
+#include "FDM_StrikeStrip.hpp"
+#include <algorithm>
+#include <cmath>
+
+FDMStrikeStrip::FDMStrikeStrip(const EuropeanOption& _option, const std::vector<double>& _strikes, double _M, double _alpha_temp, bool _isPut,
+                               FDMScheme _scheme, double _width) {
+    option = _option;
+    strikes = _strikes;
+    isPut = _isPut;
+    scheme = _scheme;
+    M = _M;
+    double sigma = option.sigma, T = option.T;
+    double drift = (option.r - option.q - 0.5 * sigma * sigma) * T;
+    double K_low = *std::min_element(strikes.begin(), strikes.end()), K_high = *std::max_element(strikes.begin(), strikes.end());
+    double Tau_final = 0.5 * T * sigma * sigma;
+    double delta_x = std::sqrt(Tau_final / M / _alpha_temp);
+    // the ends on multiples of delta_x, so the strike x = 0 is a node
+    x_left = std::floor((std::log(option.S / K_high) + drift - _width * sigma * std::sqrt(T)) / delta_x) * delta_x;
+    x_right = std::ceil((std::log(option.S / K_low) + drift + _width * sigma * std::sqrt(T)) / delta_x) * delta_x;
+    N = std::round((x_right - x_left) / delta_x);
+
+    FDMEuropean FDM(option, M, N, x_left, x_right, isPut, scheme, false);
+    double K = option.K;
+    for (double K_j : strikes) {
+        std::vector<double> values = FDM.Greeks_at(option.S * K / K_j);
+        prices.push_back(K_j / K * values[0]);
+        deltas.push_back(values[1]);
+        gammas.push_back(K / K_j * values[2]);
+        thetas.push_back(K_j / K * values[3]);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef FDM_STRIKESTRIP_HPP
+#define FDM_STRIKESTRIP_HPP
+
+#include "FDM_EuropeanOption.hpp"
+#include <vector>
+
+// European options on one underlying that differ only in the strike, priced from a single FDMEuropean solve.
+// V(S, K_j) = (K_j / K) V(S K / K_j, K) for the strike K of option, so strike K_j is read off the grid of K at the
+// spot S K / K_j, i.e. at x = log(S / K_j): every strike shares the heat equation, the payoff kink at x = 0 and the
+// boundary values, and only the point read differs. The grid spans the x of all strikes plus +-_width standard
+// deviations, with x = 0 on a node.
+class FDMStrikeStrip {
+public:
+    EuropeanOption option;       // S, T, sigma, r, q of the strip; option.K is the strike of the grid
+    std::vector<double> strikes;
+    bool isPut;
+    FDMScheme scheme;
+    double M;
+    int N;
+    double x_left;
+    double x_right;
+    // one per strike
+    std::vector<double> prices;
+    std::vector<double> deltas;
+    std::vector<double> gammas;
+    std::vector<double> thetas;
+
+    // Constructor: delta_x from _M and _alpha_temp as in FDMEuropean, then the solve and the read-out of all strikes
+    FDMStrikeStrip(const EuropeanOption& _option, const std::vector<double>& _strikes, double _M, double _alpha_temp, bool _isPut,
+                   FDMScheme _scheme = FDMScheme::ForwardEuler, double _width = 3.0);
+};
+
+#endif // FDM_STRIKESTRIP_HPP
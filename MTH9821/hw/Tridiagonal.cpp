@@ -0,0 +1,48 @@
+#include "Tridiagonal.hpp"
+#include <algorithm>
+
+TridiagonalSolver::TridiagonalSolver() {
+}
+
+void TridiagonalSolver::factor(int n, double _lower, double _diag, double _upper) {
+    std::vector<double> l(n, _lower), d(n, _diag), u(n, _upper);
+    factor(n, l.data(), d.data(), u.data());
+}
+
+void TridiagonalSolver::factor(int n, const double* _lower, const double* _diag, const double* _upper) {
+    lower.assign(_lower, _lower + n);
+    pivot.resize(n);
+    upper.resize(n);
+    double c_prev = 0.0;
+    for (int i = 0; i < n; i++) {
+        pivot[i] = 1.0 / (_diag[i] - (i > 0 ? _lower[i] * c_prev : 0.0));
+        upper[i] = i < n - 1 ? _upper[i] * pivot[i] : 0.0;
+        c_prev = upper[i];
+    }
+}
+
+void TridiagonalSolver::solve(double* rhs) const {
+    int n = pivot.size();
+    if (n == 0) return;
+    // forward elimination, then back substitution
+    rhs[0] *= pivot[0];
+    for (int i = 1; i < n; i++) {
+        rhs[i] = (rhs[i] - lower[i] * rhs[i-1]) * pivot[i];
+    }
+    for (int i = n - 2; i >= 0; i--) {
+        rhs[i] -= upper[i] * rhs[i+1];
+    }
+}
+
+void TridiagonalSolver::solveProjected(double* rhs, const double* bound) const {
+    int n = pivot.size();
+    if (n == 0) return;
+    rhs[0] *= pivot[0];
+    for (int i = 1; i < n; i++) {
+        rhs[i] = (rhs[i] - lower[i] * rhs[i-1]) * pivot[i];
+    }
+    rhs[n-1] = std::max(rhs[n-1], bound[n-1]);
+    for (int i = n - 2; i >= 0; i--) {
+        rhs[i] = std::max(rhs[i] - upper[i] * rhs[i+1], bound[i]);
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef TRIDIAGONAL_HPP
+#define TRIDIAGONAL_HPP
+
+#include <vector>
+
+// Thomas algorithm for a tridiagonal system of size n, factored once and then solved for any number of
+// right-hand sides in O(n) without allocating.
+class TridiagonalSolver {
+public:
+    std::vector<double> lower;  // sub-diagonal, lower[0] unused
+    std::vector<double> pivot;  // 1 / pivot of each row
+    std::vector<double> upper;  // super-diagonal divided by the pivot, upper[n-1] unused
+
+    // Constructor
+    TridiagonalSolver();
+
+    // Matrix with constant diagonals, e.g. the implicit heat equation steps
+    void factor(int n, double _lower, double _diag, double _upper);
+    // General matrix, row i being _lower[i] x[i-1] + _diag[i] x[i] + _upper[i] x[i+1]
+    void factor(int n, const double* _lower, const double* _diag, const double* _upper);
+
+    // Overwrites rhs[0..n-1] with the solution
+    void solve(double* rhs) const;
+    // Brennan-Schwartz: the solve with each unknown raised to bound[i] as soon as it is substituted back. Solves the
+    // obstacle problem when the region where the bound binds is at the high end of the indices, where the back
+    // substitution starts (reverse the ordering for the other end).
+    void solveProjected(double* rhs, const double* bound) const;
+};
+
+#endif // TRIDIAGONAL_HPP
@@ -0,0 +1,394 @@
+// Error against wall time of the finite difference schemes for the European put of main.cpp.
+// Build: g++ -std=c++17 -O3 -march=native bench_fdm.cpp EuropeanOption.cpp FDM_EuropeanOption.cpp FDM_AmericanOption.cpp FDM_Mesh.cpp FDM_Richardson.cpp FDM_StrikeStrip.cpp Tridiagonal.cpp -o bench_fdm
+#include "FDM_AmericanOption.hpp"
+#include "FDM_Kernel.hpp"
+#include "FDM_Richardson.hpp"
+#include "FDM_StrikeStrip.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+double normal_cdf(double x) {
+    return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+double black_scholes_put(double S, double K, double T, double sigma, double r, double q) {
+    double d1 = (std::log(S / K) + (r - q + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
+    double d2 = d1 - sigma * std::sqrt(T);
+    return K * std::exp(-r * T) * normal_cdf(-d2) - S * std::exp(-q * T) * normal_cdf(-d1);
+}
+
+// put price, delta, gamma, theta
+std::vector<double> black_scholes_put_greeks(double S, double K, double T, double sigma, double r, double q) {
+    double d1 = (std::log(S / K) + (r - q + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
+    double d2 = d1 - sigma * std::sqrt(T);
+    double density = std::exp(-0.5 * d1 * d1) / std::sqrt(2 * M_PI);
+    double delta = -std::exp(-q * T) * normal_cdf(-d1);
+    double gamma = std::exp(-q * T) * density / (S * sigma * std::sqrt(T));
+    double theta = -S * sigma * std::exp(-q * T) * density / (2 * std::sqrt(T)) + r * K * std::exp(-r * T) * normal_cdf(-d2)
+                   - q * S * std::exp(-q * T) * normal_cdf(-d1);
+    return {black_scholes_put(S, K, T, sigma, r, q), delta, gamma, theta};
+}
+
+// Largest error of the option values V = exp(-a x - b tau) u on the last row of the mesh, over the nodes within
+// one standard deviation of the spot (the far nodes carry the error of the truncated domain)
+double max_error(const FDMEuropean& FDM) {
+    const std::vector<double>& U = FDM.U_final;
+    double x_compute = std::log(FDM.S / FDM.K), width = FDM.sigma * std::sqrt(FDM.T);
+    double error = 0.0;
+    for (int i = 0; i <= FDM.N; i++) {
+        double x = FDM.x_left + i * FDM.delta_x;
+        if (std::fabs(x - x_compute) > width) continue;
+        double V = std::exp(-FDM.a * x - FDM.b * FDM.Tau_final) * U[i];
+        double exact = black_scholes_put(FDM.K * std::exp(x), FDM.K, FDM.T, FDM.sigma, FDM.r, FDM.q);
+        error = std::max(error, std::fabs(V - exact));
+    }
+    return error;
+}
+
+void bench_scheme(const char* name, const EuropeanOption& option, FDMScheme scheme, double alpha_temp, std::vector<double> Ms) {
+    for (double M : Ms) {
+        auto start = std::chrono::steady_clock::now();
+        FDMEuropean FDM(option, M, alpha_temp, true, scheme);
+        auto stop = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        std::cout << name << "\t" << alpha_temp << "\t" << M << "\t" << FDM.N << "\t" << std::fixed << std::setprecision(3) << ms
+                  << "\t\t" << std::scientific << std::setprecision(2) << max_error(FDM) << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+}
+
+// Full mesh against the rolling two-row mode: time, memory of the node values, and whether the last rows agree
+void bench_rolling(const EuropeanOption& option, FDMScheme scheme, const char* name, double alpha_temp, double M) {
+    auto time = [](auto make) {
+        auto start = std::chrono::steady_clock::now();
+        auto FDM = make();
+        auto stop = std::chrono::steady_clock::now();
+        return std::make_pair(std::chrono::duration<double, std::milli>(stop - start).count(), FDM);
+    };
+    auto full = time([&]() { return FDMEuropean(option, M, alpha_temp, true, scheme, true); });
+    auto rolling = time([&]() { return FDMEuropean(option, M, alpha_temp, true, scheme, false); });
+    double mb_full = (M + 1) * (full.second.N + 1) * sizeof(double) / 1e6;
+    double mb_rolling = 2 * (rolling.second.N + 1) * sizeof(double) / 1e6;
+    bool identical = full.second.U_final == rolling.second.U_final && full.second.U_previous == rolling.second.U_previous;
+    std::cout << name << "\t" << M << "\t" << full.second.N << "\t" << std::fixed << std::setprecision(3) << full.first << "\t" << mb_full
+              << "\t" << rolling.first << "\t" << mb_rolling << "\t" << (identical ? "yes" : "NO") << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+// Post-processing of a full mesh on the flat layout against the same values as one vector per row: allocating
+// and filling a copy, walking every column in time (e.g. theta along x), and serializing the grid
+void bench_mesh_layout(const EuropeanOption& option, double M, double alpha_temp) {
+    FDMEuropean FDM(option, M, alpha_temp, true, FDMScheme::CrankNicolson);
+    const FDMMesh& mesh = FDM.mesh;
+    auto ms = [](auto f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(stop - start).count();
+    };
+    FDMMesh flat;
+    double ms_flat_copy = ms([&]() { flat = mesh; });
+    std::vector<std::vector<double>> nested;
+    double ms_nested_copy = ms([&]() {
+        nested.resize(mesh.rows());
+        for (int j = 0; j < mesh.rows(); j++) nested[j] = mesh.row(j).copy();
+    });
+    volatile double sink = 0.0;
+    double ms_flat_columns = ms([&]() {
+        for (int i = 0; i < flat.cols(); i++) {
+            MeshView<double> column = flat.column(i);
+            double sum = 0.0;
+            for (int j = 0; j < column.size; j++) sum += column[j];
+            sink = sink + sum;
+        }
+    });
+    double ms_nested_columns = ms([&]() {
+        for (int i = 0; i < mesh.cols(); i++) {
+            double sum = 0.0;
+            for (std::size_t j = 0; j < nested.size(); j++) sum += nested[j][i];
+            sink = sink + sum;
+        }
+    });
+    // the flat grid goes out as one block, padding included; the nested one row by row
+    std::vector<double> buffer(static_cast<std::size_t>(flat.rows()) * flat.stride());
+    double ms_flat_write = ms([&]() { std::copy(flat.data(), flat.data() + buffer.size(), buffer.data()); });
+    double ms_nested_write = ms([&]() {
+        double* out = buffer.data();
+        for (const std::vector<double>& row : nested) out = std::copy(row.begin(), row.end(), out);
+    });
+    std::cout << "\nlayout\tM\tN\tcopy (ms)\tcolumns (ms)\tserialize (ms)" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "flat\t" << mesh.rows() - 1 << "\t" << FDM.N << "\t" << ms_flat_copy << "\t\t" << ms_flat_columns << "\t\t" << ms_flat_write << std::endl;
+    std::cout << "nested\t" << mesh.rows() - 1 << "\t" << FDM.N << "\t" << ms_nested_copy << "\t\t" << ms_nested_columns << "\t\t" << ms_nested_write << std::endl;
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+// American option of main.cpp against a BBSR tree with N = 20000, good to about 1e-6
+void bench_american(const EuropeanOption& option, bool isPut, double reference) {
+    std::cout << "\n" << (isPut ? "put" : "call") << ", BBSR tree " << reference << std::endl;
+    std::cout << "scheme\t\tsolver\t\tM\tN\ttime (ms)\tsweeps/step\t|error|" << std::endl;
+    // PSOR: omega = 1.2 throughout, tol = 1e-8
+    auto run = [&](const char* name, FDMScheme scheme, const char* solverName, FDMAmericanSolver solver, double alpha_temp, double M,
+                   double omega = 1.2) {
+        auto start = std::chrono::steady_clock::now();
+        FDMAmerican FDM(option, M, alpha_temp, isPut, scheme, solver, omega, 1e-8, false);
+        auto stop = std::chrono::steady_clock::now();
+        if (*name) std::cout << name << "\t" << solverName << "\t";
+        std::cout << M << "\t" << FDM.N << "\t" << std::fixed << std::setprecision(3)
+                  << std::chrono::duration<double, std::milli>(stop - start).count() << "\t\t" << std::setprecision(1) << FDM.iterations / M
+                  << "\t\t" << std::scientific << std::setprecision(2) << std::fabs(FDM.price - reference) << std::defaultfloat
+                  << std::setprecision(6) << std::endl;
+    };
+    for (double M : {256, 1024, 4096, 16384}) {
+        run("forward Euler", FDMScheme::ForwardEuler, "projection", FDMAmericanSolver::PSOR, 0.45, M);
+    }
+    // Crank-Nicolson with dt / dx fixed
+    for (double M : {16, 64, 256, 1024}) {
+        if (M <= 256) run("Crank-Nicolson", FDMScheme::CrankNicolson, "PSOR\t", FDMAmericanSolver::PSOR, M / 16.0, M);
+        run("Crank-Nicolson", FDMScheme::CrankNicolson, "Brennan-Schwartz", FDMAmericanSolver::BrennanSchwartz, M / 16.0, M);
+    }
+    // the sweeps needed by PSOR grow with alpha; over-relaxation closer to 2 brings them down
+    std::cout << "omega\tM\tN\ttime (ms)\tsweeps/step\t|error|" << std::endl;
+    for (double omega : {1.0, 1.2, 1.5, 1.8, 1.9}) {
+        std::cout << omega << "\t";
+        run("", FDMScheme::CrankNicolson, "", FDMAmericanSolver::PSOR, 16, 256, omega);
+    }
+}
+
+// Explicit time steps on n + 1 nodes: the loop Create_mesh had before, with g_left / g_right (two exp each) every
+// step, against heat_step with the boundaries advanced by their one-step factors, on each instruction set
+void bench_explicit_step(const EuropeanOption& option) {
+    FDMEuropean FDM(option, 1, 0.45, true, FDMScheme::ForwardEuler, false);
+    double alpha = 0.45, delta_Tau = 1e-7;
+    std::cout << "\nexplicit step, ns per node and step" << std::endl;
+    std::cout << "N\tsteps\tloop + exp\tscalar\t\tAVX2\t\tAVX-512" << std::endl;
+    for (int n : {1000, 10000, 100000}) {
+        int steps = 100000000 / n;
+        std::vector<double> U_prior(n+1), U_posterior(n+1);
+        auto reset = [&]() {
+            for (int i = 0; i <= n; i++) U_prior[i] = FDM.f(FDM.x_left + i * (FDM.x_right - FDM.x_left) / n);
+        };
+        auto ns = [&](auto step) {
+            reset();
+            double* prior = U_prior.data();
+            double* posterior = U_posterior.data();
+            auto start = std::chrono::steady_clock::now();
+            for (int j = 1; j <= steps; j++) {
+                step(j, prior, posterior);
+                std::swap(prior, posterior);
+            }
+            auto stop = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::nano>(stop - start).count() / (double(steps) * n);
+        };
+        double ns_loop = ns([&](int j, double* prior, double* posterior) {
+            for (int i = 1; i < n; i++){
+                posterior[i] = alpha * prior[i-1] + (1-2*alpha) * prior[i] + alpha * prior[i+1];
+            }
+            posterior[0] = FDM.g_left(j*delta_Tau);
+            posterior[n] = FDM.g_right(j*delta_Tau);
+        });
+        std::cout << n << "\t" << steps << "\t" << std::fixed << std::setprecision(3) << ns_loop;
+        for (FDMSimdLevel level : {FDM_SIMD_SCALAR, FDM_SIMD_AVX2, FDM_SIMD_AVX512}) {
+            set_fdm_simd_level(level);
+            double step_r = std::exp((FDM.b - 2*FDM.r/(FDM.sigma*FDM.sigma)) * delta_Tau), step_q = std::exp((FDM.b - 2*FDM.q/(FDM.sigma*FDM.sigma)) * delta_Tau);
+            double scale_left = FDM.K * std::exp(FDM.a*FDM.x_left), spot_left = std::exp(FDM.x_left);
+            double discount_r = 1.0, discount_q = 1.0;
+            double ns_kernel = ns([&](int, double* prior, double* posterior) {
+                discount_r *= step_r;
+                discount_q *= step_q;
+                posterior[0] = scale_left * (discount_r - spot_left * discount_q);
+                posterior[n] = 0.0;
+                heat_step(prior, posterior, n, alpha);
+            });
+            std::cout << "\t\t" << ns_kernel;
+        }
+        set_fdm_simd_level(FDM_SIMD_AVX512);
+        std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+}
+
+// Price and Greeks at the spot from one price-only solve, against Black-Scholes (European) and the BBSR tree (American)
+void bench_greeks(const EuropeanOption& option) {
+    std::cout << "\nGreeks at S0 = " << option.S << ", Crank-Nicolson without and with the Rannacher start-up, price-only mode" << std::endl;
+    std::cout << "option\t\tstart-up\tM\tN\ttime (ms)\t|price err|\t|delta err|\t|gamma err|\t|theta err|" << std::endl;
+    std::vector<double> european = black_scholes_put_greeks(option.S, option.K, option.T, option.sigma, option.r, option.q);
+    std::vector<double> american = {6.822830, -0.618608, 0.040859, -2.019398};  // BBSR, N = 20000
+    for (bool isAmerican : {false, true}) {
+        for (FDMScheme scheme : {FDMScheme::CrankNicolson, FDMScheme::CrankNicolsonRannacher}) {
+            for (double M : {64, 256, 1024}) {
+                auto start = std::chrono::steady_clock::now();
+                FDMEuropean FDM = isAmerican ? FDMAmerican(option, M, M / 16.0, true, scheme, FDMAmericanSolver::BrennanSchwartz, 1.2, 1e-8, false)
+                                             : FDMEuropean(option, M, M / 16.0, true, scheme, false);
+                auto stop = std::chrono::steady_clock::now();
+                const std::vector<double>& exact = isAmerican ? american : european;
+                std::cout << (isAmerican ? "American put" : "European put") << "\t" << (scheme == FDMScheme::CrankNicolson ? "none" : "Rannacher")
+                          << "\t" << M << "\t" << FDM.N << "\t" << std::fixed << std::setprecision(3)
+                          << std::chrono::duration<double, std::milli>(stop - start).count() << std::scientific << std::setprecision(2)
+                          << "\t\t" << std::fabs(FDM.price - exact[0]) << "\t" << std::fabs(FDM.delta - exact[1]) << "\t" << std::fabs(FDM.gamma - exact[2])
+                          << "\t" << std::fabs(FDM.theta - exact[3]) << std::defaultfloat << std::setprecision(6) << std::endl;
+            }
+        }
+    }
+}
+
+// Richardson extrapolation against Black-Scholes: each level's own error, and the error of the last column of the
+// table after all levels so far, with the time of all solves so far
+void bench_richardson(const EuropeanOption& option, FDMScheme scheme, const char* name, double M0, double alpha_temp, int levels, double width) {
+    double exact = black_scholes_put(option.S, option.K, option.T, option.sigma, option.r, option.q);
+    FDMRichardson richardson(option, M0, alpha_temp, true, scheme, width);
+    std::cout << "\n" << name << ", Richardson, domain +-" << width << " sd" << std::endl;
+    std::cout << "M\tN\ttotal (ms)\t|level error|\t|extrapolated error|" << std::endl;
+    double total = 0.0;
+    for (int k = 0; k < levels; k++) {
+        richardson.Add_level();
+        total += richardson.milliseconds.back();
+        double M = richardson.M0 * std::pow(scheme == FDMScheme::ForwardEuler || scheme == FDMScheme::BackwardEuler ? 4.0 : 2.0, k);
+        std::cout << M << "\t" << (richardson.N0 << k) << "\t" << std::fixed << std::setprecision(3) << total << "\t\t" << std::scientific
+                  << std::setprecision(2) << std::fabs(richardson.prices.back() - exact) << "\t" << std::fabs(richardson.price() - exact)
+                  << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+}
+
+// Uniform grid against the sinh grid clustered at the spot, both with the strike and the spot on nodes, at about the
+// same number of nodes, with Crank-Nicolson on enough time steps that the spatial error dominates
+void bench_nonuniform(const EuropeanOption& option, double M, std::vector<double> clusterings) {
+    std::vector<double> exact = black_scholes_put_greeks(option.S, option.K, option.T, option.sigma, option.r, option.q);
+    double center = std::log(option.S / option.K) + (option.r - option.q - 0.5 * option.sigma * option.sigma) * option.T;
+    double x_left = center - 3 * option.sigma * std::sqrt(option.T), x_right = center + 3 * option.sigma * std::sqrt(option.T);
+    std::cout << "\nuniform and sinh grids, Crank-Nicolson, M = " << M << ", |price error| / |gamma error|" << std::endl;
+    std::cout << "N\tuniform";
+    for (double c : clusterings) std::cout << "\t\t\tc = " << c;
+    std::cout << std::endl;
+    for (int N : {25, 50, 100, 200, 400, 800}) {
+        // uniform grid with the strike and the spot on nodes, as the sinh grids have them
+        double x_spot = std::log(option.S / option.K);
+        double delta_x = std::fabs(x_spot) / std::ceil(std::fabs(x_spot) / ((x_right - x_left) / N));
+        double aligned_left = -std::ceil(-x_left / delta_x) * delta_x;
+        FDMEuropean uniform(option, M, N, aligned_left, aligned_left + N * delta_x, true, FDMScheme::CrankNicolson, false);
+        std::cout << N << std::scientific << std::setprecision(2) << "\t" << std::fabs(uniform.price - exact[0]) << " / " << std::fabs(uniform.gamma - exact[2]);
+        for (double c : clusterings) {
+            FDMEuropean sinh(option, M, N, x_left, x_right, true, FDMScheme::CrankNicolson, false, c);
+            std::cout << "\t" << std::fabs(sinh.price - exact[0]) << " / " << std::fabs(sinh.gamma - exact[2]);
+        }
+        std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+}
+
+// Largest gamma error on the nodes within one standard deviation of the strike, from the three-point differences of
+// the last row; plain Crank-Nicolson leaves the payoff kink there as a node-to-node oscillation
+double max_gamma_error(const FDMEuropean& FDM) {
+    double width = FDM.sigma * std::sqrt(FDM.T), error = 0.0;
+    auto S_node = [&](int i) { return FDM.K * std::exp(FDM.x_nodes[i]); };
+    auto V_node = [&](int i) { return std::exp(-FDM.a * FDM.x_nodes[i] - FDM.b * FDM.Tau_final) * FDM.U_final[i]; };
+    for (int i = 1; i < FDM.N; i++) {
+        if (std::fabs(FDM.x_nodes[i]) > width) continue;
+        double gamma = ((V_node(i+1) - V_node(i)) / (S_node(i+1) - S_node(i)) - (V_node(i) - V_node(i-1)) / (S_node(i) - S_node(i-1)))
+                       / ((S_node(i+1) - S_node(i-1)) / 2);
+        double exact = black_scholes_put_greeks(S_node(i), FDM.K, FDM.T, FDM.sigma, FDM.r, FDM.q)[2];
+        error = std::max(error, std::fabs(gamma - exact));
+    }
+    return error;
+}
+
+// Crank-Nicolson with and without the Rannacher start-up, dx and dt halved together from a short maturity (large
+// delta_Tau / dx^2), on uniform grids with the strike and the spot on nodes; ratio: error on the coarser grid / error
+void bench_rannacher(const EuropeanOption& option) {
+    std::vector<double> exact = black_scholes_put_greeks(option.S, option.K, option.T, option.sigma, option.r, option.q);
+    double center = std::log(option.S / option.K) + (option.r - option.q - 0.5 * option.sigma * option.sigma) * option.T;
+    double x_left = center - 4 * option.sigma * std::sqrt(option.T), x_spot = std::log(option.S / option.K);
+    std::cout << "\nCrank-Nicolson start-up, M = N / 8, price, delta and gamma errors at S0 (ratio), largest gamma error near the strike" << std::endl;
+    std::cout << "scheme\t\tN\talpha\t|price err|\t\t|delta err|\t\t|gamma err|\t\tmax |gamma err|" << std::endl;
+    for (FDMScheme scheme : {FDMScheme::CrankNicolson, FDMScheme::CrankNicolsonRannacher}) {
+        std::vector<double> previous;
+        for (int k = 1; k <= 64; k *= 2) {
+            double delta_x = std::fabs(x_spot) / (4 * k);
+            int n_left = std::ceil(-x_left / delta_x), N = 2 * n_left;
+            FDMEuropean FDM(option, N / 8, N, -n_left * delta_x, n_left * delta_x, true, scheme, false);
+            std::vector<double> errors = {std::fabs(FDM.price - exact[0]), std::fabs(FDM.delta - exact[1]), std::fabs(FDM.gamma - exact[2])};
+            std::cout << (scheme == FDMScheme::CrankNicolson ? "Crank-Nicolson" : "Rannacher") << "\t" << N << "\t" << std::fixed
+                      << std::setprecision(2) << FDM.alpha << std::scientific;
+            for (int e = 0; e < 3; e++) {
+                std::cout << "\t" << errors[e];
+                if (previous.empty()) std::cout << "\t\t";
+                else std::cout << " (" << std::fixed << std::setprecision(1) << previous[e] / errors[e] << ")\t" << std::scientific << std::setprecision(2);
+            }
+            std::cout << "\t" << max_gamma_error(FDM) << std::defaultfloat << std::setprecision(6) << std::endl;
+            previous = errors;
+        }
+    }
+}
+
+// A strip of puts, strikes evenly spread over [K_low, K_high]: one FDMStrikeStrip solve against one FDMEuropean per
+// strike at the same M and alpha, with the largest price and gamma errors over the strikes
+void bench_strike_strip(const EuropeanOption& option, FDMScheme scheme, double M, double alpha_temp, double K_low, double K_high, int count) {
+    std::vector<double> strikes;
+    for (int j = 0; j < count; j++) strikes.push_back(K_low + (K_high - K_low) * j / (count - 1));
+    auto max_errors = [&](auto value) {
+        double price_error = 0.0, gamma_error = 0.0;
+        for (int j = 0; j < count; j++) {
+            std::vector<double> exact = black_scholes_put_greeks(option.S, strikes[j], option.T, option.sigma, option.r, option.q);
+            std::vector<double> values = value(j);
+            price_error = std::max(price_error, std::fabs(values[0] - exact[0]));
+            gamma_error = std::max(gamma_error, std::fabs(values[1] - exact[2]));
+        }
+        return std::make_pair(price_error, gamma_error);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    FDMStrikeStrip strip(option, strikes, M, alpha_temp, true, scheme);
+    auto stop = std::chrono::steady_clock::now();
+    double strip_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    auto strip_errors = max_errors([&](int j) { return std::vector<double>{strip.prices[j], strip.gammas[j]}; });
+
+    std::vector<double> prices, gammas;
+    int N_single = 0;
+    start = std::chrono::steady_clock::now();
+    for (double K : strikes) {
+        FDMEuropean FDM(EuropeanOption(option.t, option.S, K, option.T, option.sigma, option.r, option.q), M, alpha_temp, true, scheme, false);
+        prices.push_back(FDM.price);
+        gammas.push_back(FDM.gamma);
+        N_single = std::max(N_single, FDM.N);
+    }
+    stop = std::chrono::steady_clock::now();
+    double single_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    auto single_errors = max_errors([&](int j) { return std::vector<double>{prices[j], gammas[j]}; });
+
+    std::cout << "\n" << count << " put strikes in [" << K_low << ", " << K_high << "], M = " << M << ", alpha = " << alpha_temp << std::endl;
+    std::cout << "method\t\tsolves\tN\ttime (ms)\tmax |price err|\tmax |gamma err|" << std::endl;
+    std::cout << "one grid\t1\t" << strip.N << "\t" << std::fixed << std::setprecision(3) << strip_ms << "\t\t" << std::scientific << std::setprecision(2)
+              << strip_errors.first << "\t" << strip_errors.second << std::defaultfloat << std::setprecision(6) << std::endl;
+    std::cout << "per strike\t" << count << "\t" << N_single << "\t" << std::fixed << std::setprecision(3) << single_ms << "\t\t" << std::scientific
+              << std::setprecision(2) << single_errors.first << "\t" << single_errors.second << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+int main() {
+    EuropeanOption option(0, 35, 40, 0.75, 0.33, 0.04, 0.02);
+    std::cout << "scheme\t\talpha\tM\tN\ttime (ms)\tmax error" << std::endl;
+    bench_scheme("forward Euler", option, FDMScheme::ForwardEuler, 0.45, {64, 256, 1024, 4096, 16384});
+    bench_scheme("backward Euler", option, FDMScheme::BackwardEuler, 0.45, {64, 256, 1024, 4096, 16384});
+    bench_scheme("backward Euler", option, FDMScheme::BackwardEuler, 5.0, {64, 256, 1024, 4096, 16384});
+    // Crank-Nicolson is second order in time: dx and dt shrink together at fixed dt / dx
+    bench_scheme("Crank-Nicolson", option, FDMScheme::CrankNicolson, 0.45, {64, 256, 1024, 4096, 16384});
+    for (double M : {16, 32, 64, 128, 256, 512}) {
+        bench_scheme("Crank-Nicolson", option, FDMScheme::CrankNicolson, M / 32.0 * 2.0, {M});
+    }
+
+    std::cout << "\nscheme\t\tM\tN\tfull (ms)\tfull (MB)\trolling (ms)\trolling (MB)\tidentical" << std::endl;
+    bench_rolling(option, FDMScheme::ForwardEuler, "forward Euler", 0.45, 16384);
+    bench_rolling(option, FDMScheme::CrankNicolson, "Crank-Nicolson", 0.45, 16384);
+    bench_rolling(option, FDMScheme::CrankNicolson, "Crank-Nicolson", 32, 4096);
+    bench_mesh_layout(option, 4096, 32);
+    bench_american(option, true, 6.822830);
+    bench_american(option, false, 2.344989);
+    bench_explicit_step(option);
+    bench_greeks(option);
+    bench_richardson(option, FDMScheme::ForwardEuler, "forward Euler", 16, 0.45, 5, 3.0);
+    bench_richardson(option, FDMScheme::CrankNicolson, "Crank-Nicolson", 16, 1.0, 6, 3.0);
+    bench_richardson(option, FDMScheme::CrankNicolson, "Crank-Nicolson", 16, 1.0, 6, 4.0);
+    bench_nonuniform(option, 4000, {0.1, 0.2, 0.4, 1.0});
+    bench_rannacher(option);
+    bench_strike_strip(option, FDMScheme::CrankNicolsonRannacher, 256, 16, 25, 55, 100);
+    bench_strike_strip(option, FDMScheme::CrankNicolsonRannacher, 1024, 64, 25, 55, 100);
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Timing of the implied volatility solvers, separate from main.cpp so the homework tables stay fast to produce.
+// Build: g++ -std=c++17 -O3 -march=native -pthread bench_implied_volatility.cpp -o bench_implied_volatility
+#include "binomial_implied_volatility.hpp"
+#include "implied_volatility_surface.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+// wall time in milliseconds of one call of f
+template <typename F>
+double time_ms(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// European quotes over strikes 0.5 S0 .. 2 S0 and the forward, vols 5% .. 150% and three expiries, both types;
+// quotes whose out of the money price is below 1e-8 carry no time value in double precision and are left out
+std::vector<OptionQuote> european_quotes(double S0, double r, double q, std::vector<double>& vols)
+{
+    std::vector<OptionQuote> quotes;
+    for (double T : {0.1, 1.0, 5.0})
+    {
+        std::vector<double> strikes{S0 * std::exp((r - q) * T)};
+        for (double K = 0.5 * S0; K <= 2.0 * S0; K *= 1.1)
+            strikes.push_back(K);
+        for (double K : strikes)
+            for (double sigma = 0.05; sigma <= 1.5; sigma *= 1.25)
+                for (const char *type : {"put", "call"})
+                {
+                    if (std::min(black_scholes_price(S0, K, T, sigma, r, q, true), black_scholes_price(S0, K, T, sigma, r, q, false)) < 1e-8)
+                        continue;
+                    quotes.push_back({K, T, black_scholes_price(S0, K, T, sigma, r, q, std::string(type) == "put"), type});
+                    vols.push_back(sigma);
+                }
+    }
+    return quotes;
+}
+
+void bench_analytic()
+{
+    std::cout << "\n-BLACK-SCHOLES IMPLIED VOLATILITY, normalised Black with Householder steps\n" << std::endl;
+    double S0 = 41.0, r = 0.035, q = 0.0075;
+    std::vector<double> vols;
+    std::vector<OptionQuote> quotes = european_quotes(S0, r, q, vols);
+    double max_error = 0.0;
+    volatile double sink = 0.0;
+    int repeat = 50;
+    double ms = time_ms([&]() {
+        for (int k = 0; k < repeat; k++)
+            for (const OptionQuote &quote : quotes)
+                sink = black_scholes_implied_volatility(quote.price, S0, quote.K, quote.T, r, q, quote.type == "put");
+    });
+    for (std::size_t i = 0; i < quotes.size(); i++)
+    {
+        double sigma = black_scholes_implied_volatility(quotes[i].price, S0, quotes[i].K, quotes[i].T, r, q, quotes[i].type == "put");
+        max_error = std::max(max_error, std::fabs(sigma - vols[i]) / vols[i]);
+    }
+    std::cout << "quotes\tquotes/s\tmax relative error" << std::endl;
+    std::cout << quotes.size() << "\t" << std::setprecision(0) << quotes.size() * repeat / ms * 1000.0 << "\t" << std::scientific
+              << std::setprecision(2) << max_error << std::fixed << std::setprecision(6) << std::endl;
+}
+
+// Tree implied vols of the same European quotes, seeded from Corrado-Miller or from the exact Black-Scholes vol
+void bench_tree_seed(int N)
+{
+    std::cout << "\n-BBSR TREE IMPLIED VOLATILITY, N = " << N << "\n" << std::endl;
+    double S0 = 41.0, r = 0.035, q = 0.0075;
+    std::vector<double> vols;
+    std::vector<OptionQuote> quotes = european_quotes(S0, r, q, vols);
+    std::cout << "seed\t\ttrees/quote\tquotes/s\tconverged" << std::endl;
+    for (bool exact : {false, true})
+    {
+        bbsrCache().clear();
+        int evaluations = 0, converged = 0;
+        double ms = time_ms([&]() {
+            for (const OptionQuote &quote : quotes)
+            {
+                double seed = exact ? impliedVolatilitySeed(quote.price, S0, quote.K, r, quote.T, q, quote.type)
+                                    : corradoMillerVolatility(quote.price, S0, quote.K, r, quote.T, q, quote.type);
+                double seed_vega = black_scholes_values(S0, quote.K, quote.T, seed, r, q)["vega"];
+                auto price = [&](double sigma) { return calculateOptionPrice_BBSR(sigma, S0, quote.K, r, quote.T, q, N, quote.type); };
+                ImpliedVolResult result = solveImpliedVolatility(price, quote.price, seed, seed_vega);
+                evaluations += result.evaluations;
+                converged += result.converged;
+            }
+        });
+        std::cout << (exact ? "Black-Scholes" : "Corrado-Miller") << "\t" << std::setprecision(2) << double(evaluations) / quotes.size() << "\t\t"
+                  << std::setprecision(0) << quotes.size() / ms * 1000.0 << "\t\t" << converged << "/" << quotes.size() << std::setprecision(6) << std::endl;
+    }
+}
+
+// Surface of an American chain priced on the same trees at sigma = 30%, with the group shapes that stress the
+// outward ordering: a single quote, and a group whose strike closest to S0 is its largest
+void bench_surface(int N)
+{
+    std::cout << "\n-AMERICAN VOL SURFACE, N = " << N << "\n" << std::endl;
+    double S0 = 41.0, r = 0.035, q = 0.0075, sigma = 0.3;
+    std::vector<OptionQuote> chain;
+    auto quote = [&](double K, double T, const char *type) {
+        BinomialAmerican tree(S0, K, r, sigma, T, q, N, "BBSR", type);
+        tree.runSimulation();
+        chain.push_back({K, T, tree.getPrice(), type});
+    };
+    quote(45.0, 0.25, "call");  // a group of one quote
+    for (double K : {30.0, 35.0, 40.0}) quote(K, 0.5, "put");  // money strike last
+    for (double K : {35.0, 40.0, 45.0, 50.0}) quote(K, 1.0, "put");
+    for (double K : {35.0, 40.0, 45.0, 50.0}) quote(K, 1.0, "call");
+    VolSurface surface;
+    double ms = time_ms([&]() { surface = buildVolSurface(chain, S0, r, q, N, true); });
+    double max_error = 0.0;
+    int converged = 0;
+    for (double vol : surface.quote_vols)
+    {
+        if (std::isnan(vol))
+            continue;
+        converged++;
+        max_error = std::max(max_error, std::fabs(vol - sigma));
+    }
+    std::cout << "quotes	time (ms)	converged	max |vol error|" << std::endl;
+    std::cout << chain.size() << "\t" << std::setprecision(2) << ms << "\t\t" << converged << "/" << chain.size() << "\t\t" << std::scientific
+              << max_error << std::fixed << std::setprecision(6) << std::endl;
+}
+
+int main()
+{
+    std::cout << std::fixed << std::setprecision(6);
+    bench_analytic();
+    bench_tree_seed(500);
+    bench_surface(500);
+    return 0;
+}
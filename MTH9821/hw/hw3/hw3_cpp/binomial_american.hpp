@@ -3,6 +3,7 @@
 
 #include "black_scholes.hpp"
 #include "binomial_option.hpp"
+#include "lattice_parallel.hpp"
 
 #ifndef Option_value
 #define Option_value
@@ -28,33 +29,68 @@ class BinomialAmerican : public BinomialOption
 {
 private:
     std::vector<std::string> methods{"Binomial", "AverageBinomial", "BBS", "BBSR"};
-    double S_temp;
-    std::vector<double> V;
+    LatticeBuffer V; // reused across runs, sized to the leaf level on every call
+    BinomialExerciseTable exercise;
+    bool track_boundary = false;
+    ExerciseBoundary boundary;
     double V10, V11, V20, V21, V22;
     double price, delta1, gamma1, theta1;
 
-public:
-    BinomialAmerican(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
-        : BinomialOption(S0_, K_, r_, sigma_, T_, q_, N_, method_, type_)
+    // Backward induction from the leaves already stored in V at level top down to the root
+    void backwardInduction(int top)
     {
-        
-        if (method == "Binomial")
+        FlushDenormals ftz;
+        exercise.build(S0, u, d_bar, K, N, type == "put");
+        int j = top - 1;
+        if (track_boundary)
         {
-            S_temp = S0 * pow(u, N);
+            boundary.start(S0, K, u, exp(-r * dt), disc_p * u + disc_1p * d, type == "put", false, V.data(), exercise.level(top), top);
         }
-        else if (method == "AverageBinomial")
+        // parallel or blocked sweep down to level 2, the last two levels are stepped below to record the Greeks;
+        // boundary tracking goes level by level, skipping the continuation and deep exercise nodes
+        auto european = [&](double *v, int last) { binomial_step(v, last, disc_p, disc_1p); };
+        auto american = [&](double *v, const double *ex, int last) { binomial_step_american(v, ex, last, disc_p, disc_1p); };
+        if (!track_boundary && threads > 1 && top > 2)
         {
-            // do nothing
+            binomial_induction_parallel(V.data(), top, 2, disc_p, disc_1p, &exercise, threads, tile_levels > 0 ? tile_levels : 32);
+            j = 1;
         }
-        else if (method == "BBS")
+        else if (!track_boundary && tile_width > 0 && tile_levels > 0 && top > 2)
         {
-            S_temp = S0 * pow(u, N - 1);
+            binomial_induction_tiled(V.data(), top, 2, disc_p, disc_1p, &exercise, tile_width, tile_levels);
+            j = 1;
         }
-        else if (method == "BBSR")
+        for (; j >= 0; j--)
         {
-            // do nothing
+            if (j == 0)
+            {
+                V10 = V[0];
+                V11 = V[1];
+            }
+            if (j == 1)
+            {
+                V20 = V[0];
+                V21 = V[1];
+                V22 = V[2];
+            }
+            if (track_boundary)
+                boundary.step(V.data(), exercise.level(j), j, european, american);
+            else
+                binomial_step_american(V.data(), exercise.level(j), j, disc_p, disc_1p);
         }
-        else
+        // calculate price, delta, gamma, theta
+        price = V[0];
+        delta1 = (V10 - V11) / (S0 * (u - d));
+        gamma1 = ((V20 - V21) / (S0 * u * (u - d)) - (V21 - V22) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
+        theta1 = (V21 - price) / (2 * dt);
+    }
+
+public:
+    BinomialAmerican(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
+        : BinomialOption(S0_, K_, r_, sigma_, T_, q_, N_, method_, type_)
+    {
+        
+        if (method != "Binomial" && method != "AverageBinomial" && method != "BBS" && method != "BBSR")
         {
             std::cout << "Method not found!" << std::endl;
         }
@@ -66,44 +102,39 @@ public:
     double getGamma() const { return gamma1; }
     double getTheta() const { return theta1; }
 
+    // Track the early exercise boundary during the induction (serial, ignores tiling and threads). Nodes out of
+    // the money skip the exercise check and nodes deep in the exercise region take the payoff directly.
+    void setBoundaryTracking(bool on) { track_boundary = on; }
+
+    // Boundary spot at each level j = 0..N - 1 (time j * dt) of the last run with tracking on, see ExerciseBoundary;
+    // the combined methods report the boundary of their N step tree
+    const std::vector<double> &getExerciseBoundary() const { return boundary.spots(); }
+
     void runSimulation()
     {
         if (method == "Binomial")
         {
+            V.resize(N + 1);
+            double S_temp = S0 * pow(u, N);
             for (int i = 0; i <= N; i++)
             {
-                V.push_back(option_value(K, S_temp, type));
+                V[i] = option_value(K, S_temp, type);
                 S_temp *= d_bar;
             }
-            for (int j = N - 1; j >= 0; j--)
-            {
-                if (j == 0)
-                {
-                    V10 = V[0];
-                    V11 = V[1];
-                }
-                if (j == 1)
-                {
-                    V20 = V[0];
-                    V21 = V[1];
-                    V22 = V[2];
-                }
-                for (int i = 0; i <= j; i++)
-                {
-                    V[i] = std::max(disc_p * V[i] + disc_1p * V[i + 1], std::max(0.0,K - S0*pow(u,j-2*i)));
-                }
-            }
-            // calculate price, delta, gamma, theta
-            price = V[0];
-            delta1 = (V10 - V11) / (S0 * (u - d));
-            gamma1 = ((V20 - V21) / (S0 * u * (u - d)) - (V21 - V22) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
-            theta1 = (V21 - price) / (2 * dt);
+            backwardInduction(N);
         }
         else if (method == "AverageBinomial")
         {
             BinomialAmerican tree_N = BinomialAmerican(S0, K, r, sigma, T, q, N, "Binomial", type);
             BinomialAmerican tree_Nplus1 = BinomialAmerican(S0, K, r, sigma, T, q, N + 1, "Binomial", type);
+            tree_N.setTiling(tile_width, tile_levels);
+            tree_N.setThreads(threads);
+            tree_N.setBoundaryTracking(track_boundary);
+            tree_Nplus1.setTiling(tile_width, tile_levels);
+            tree_Nplus1.setThreads(threads);
+            tree_Nplus1.setBoundaryTracking(track_boundary);
             tree_N.runSimulation();
+            boundary = tree_N.boundary;
             tree_Nplus1.runSimulation();
             price = (tree_N.getPrice() + tree_Nplus1.getPrice()) / 2;
             delta1 = (tree_N.getDelta() + tree_Nplus1.getDelta()) / 2;
@@ -112,41 +143,27 @@ public:
         }
         else if (method == "BBS")
         {
+            V.resize(N);
+            double S_temp = S0 * pow(u, N - 1);
             for (int i = 0; i <= N - 1; i++)
             {
-                V.push_back(black_scholes_values(S_temp, K, dt, sigma, r, q)[type + "_price"]);
+                V[i] = black_scholes_values(S_temp, K, dt, sigma, r, q)[type + "_price"];
                 S_temp *= d_bar;
             }
-            for (int j = N - 2; j >= 0; j--)
-            {
-                if (j == 0)
-                {
-                    V10 = V[0];
-                    V11 = V[1];
-                }
-                if (j == 1)
-                {
-                    V20 = V[0];
-                    V21 = V[1];
-                    V22 = V[2];
-                }
-                for (int i = 0; i <= j; i++)
-                {
-                    V[i] = std::max(disc_p * V[i] + disc_1p * V[i + 1], std::max(0.0,K - S0*pow(u,j-2*i)));
-                    // V[i] = disc_p * V[i] + disc_1p * V[i + 1];
-                }
-            }
-            // calculate price, delta, gamma, theta
-            price = V[0];
-            delta1 = (V10 - V11) / (S0 * (u - d));
-            gamma1 = ((V20 - V21) / (S0 * u * (u - d)) - (V21 - V22) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
-            theta1 = (V21 - price) / (2 * dt);
+            backwardInduction(N - 1);
         }
         else if (method == "BBSR")
         {
             BinomialAmerican tree_N = BinomialAmerican(S0, K, r, sigma, T, q, N, "BBS", type);
             BinomialAmerican tree_halfN = BinomialAmerican(S0, K, r, sigma, T, q, N / 2, "BBS", type);
+            tree_N.setTiling(tile_width, tile_levels);
+            tree_N.setThreads(threads);
+            tree_N.setBoundaryTracking(track_boundary);
+            tree_halfN.setTiling(tile_width, tile_levels);
+            tree_halfN.setThreads(threads);
+            tree_halfN.setBoundaryTracking(track_boundary);
             tree_N.runSimulation();
+            boundary = tree_N.boundary;
             tree_halfN.runSimulation();
             price = 2 * tree_N.getPrice() - tree_halfN.getPrice();
             delta1 = 2 * tree_N.getDelta() - tree_halfN.getDelta();
@@ -9,6 +9,7 @@
 */
 #include "black_scholes.hpp"
 #include "binomial_option.hpp"
+#include "lattice_parallel.hpp"
 
 #ifndef Option_value
 #define Option_value
@@ -43,10 +44,89 @@ private:
     std::string method;
     */
     std::vector<std::string> methods{"Binomial", "AverageBinomial", "BBS", "BBSR"}; // KEEP THIS and below
-    double S_temp;
-    std::vector<double> V;
+    LatticeBuffer V; // reused across runs, sized to the leaf level on every call
     double V10, V11, V20, V21, V22;
     double price, delta1, gamma1, theta1;
+    double truncation = 0.0; // half-width of the truncated lattice in standard deviations, 0 = full lattice
+
+    // Truncated lattice: node i of level j sits at S0 * u^e, e = j - 2i, and only the nodes with |e| <= W are
+    // stepped. W covers `truncation` standard deviations of ln(S_T / S0) plus the drift over T, so each level
+    // costs O(W) = O(sqrt(N)) instead of O(N).
+    int bandWidth() const
+    {
+        double width = (truncation * sigma * sqrt(T) + std::abs(r - q - sigma * sigma / 2) * T) / log(u);
+        return std::max(2, int(ceil(width)));
+    }
+    int bandLow(int j, int W) const { return j > W ? (j - W + 1) / 2 : 0; }
+    int bandHigh(int j, int W) const { return std::min(j, (j + W) / 2); }
+
+    // Black-Scholes value of node i of level j, used for the nodes just outside the band
+    double nodeValue(int j, int i) const
+    {
+        double S = S0 * pow(u, j - 2 * i);
+        if (j == N)
+            return option_value(K, S, type);
+        return black_scholes_price(S, K, (N - j) * dt, sigma, r, q, type == "put");
+    }
+
+    // Levels top - 1 down to 2 on the band only; the children of the band's edge nodes that fall outside
+    // the band of the level above take their Black-Scholes value
+    void truncatedInduction(int top)
+    {
+        int W = bandWidth();
+        for (int j = top - 1; j >= 2; j--)
+        {
+            int lo = bandLow(j, W), hi = bandHigh(j, W);
+            for (int i = lo; i < bandLow(j + 1, W); i++)
+                V[i] = nodeValue(j + 1, i);
+            for (int i = bandHigh(j + 1, W) + 1; i <= hi + 1; i++)
+                V[i] = nodeValue(j + 1, i);
+            binomial_step(V.data() + lo, hi - lo, disc_p, disc_1p);
+        }
+    }
+
+    // Backward induction from the leaves already stored in V at level top down to the root
+    void backwardInduction(int top)
+    {
+        FlushDenormals ftz;
+        int j = top - 1;
+        // truncated, parallel or blocked sweep down to level 2, the last two levels are stepped below to record the Greeks
+        if (truncation > 0 && top > 2)
+        {
+            truncatedInduction(top);
+            j = 1;
+        }
+        else if (threads > 1 && top > 2)
+        {
+            binomial_induction_parallel(V.data(), top, 2, disc_p, disc_1p, nullptr, threads, tile_levels > 0 ? tile_levels : 32);
+            j = 1;
+        }
+        else if (tile_width > 0 && tile_levels > 0 && top > 2)
+        {
+            binomial_induction_tiled(V.data(), top, 2, disc_p, disc_1p, nullptr, tile_width, tile_levels);
+            j = 1;
+        }
+        for (; j >= 0; j--)
+        {
+            if (j == 0)
+            {
+                V10 = V[0];
+                V11 = V[1];
+            }
+            if (j == 1)
+            {
+                V20 = V[0];
+                V21 = V[1];
+                V22 = V[2];
+            }
+            binomial_step(V.data(), j, disc_p, disc_1p);
+        }
+        // calculate price, delta, gamma, theta
+        price = V[0];
+        delta1 = (V10 - V11) / (S0 * (u - d));
+        gamma1 = ((V20 - V21) / (S0 * u * (u - d)) - (V21 - V22) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
+        theta1 = (V21 - price) / (2 * dt);
+    }
 
 public:
     BinomialEuropean(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
@@ -69,23 +149,7 @@ public:
         disc_p = exp(-r * dt) * (exp((r - q) * dt) - d) / (u - d);
         disc_1p = exp(-r * dt) - disc_p;
         */
-        if (method == "Binomial")
-        {
-            S_temp = S0 * pow(u, N);
-        }
-        else if (method == "AverageBinomial")
-        {
-            // do nothing
-        }
-        else if (method == "BBS")
-        {
-            S_temp = S0 * pow(u, N - 1);
-        }
-        else if (method == "BBSR")
-        {
-            // do nothing
-        }
-        else
+        if (method != "Binomial" && method != "AverageBinomial" && method != "BBS" && method != "BBSR")
         {
             std::cout << "Method not found!" << std::endl;
         }
@@ -97,43 +161,35 @@ public:
     double getGamma() const { return gamma1; }
     double getTheta() const { return theta1; }
 
+    // Step only the nodes within nsd standard deviations (plus drift) of the spot and give the nodes just
+    // outside their Black-Scholes value; serial, ignores tiling and threads. 0 restores the full lattice.
+    void setTruncation(double nsd) { truncation = nsd; }
+
     void runSimulation()
     {
         if (method == "Binomial")
         {
+            V.resize(N + 1);
+            double S_temp = S0 * pow(u, N);
+            int lo = truncation > 0 ? bandLow(N, bandWidth()) : 0, hi = truncation > 0 ? bandHigh(N, bandWidth()) : N;
             for (int i = 0; i <= N; i++)
             {
-                V.push_back(option_value(K, S_temp, type));
+                if (i >= lo && i <= hi)
+                    V[i] = option_value(K, S_temp, type);
                 S_temp *= d_bar;
             }
-            for (int j = N - 1; j >= 0; j--)
-            {
-                if (j == 0)
-                {
-                    V10 = V[0];
-                    V11 = V[1];
-                }
-                if (j == 1)
-                {
-                    V20 = V[0];
-                    V21 = V[1];
-                    V22 = V[2];
-                }
-                for (int i = 0; i <= j; i++)
-                {
-                    V[i] = disc_p * V[i] + disc_1p * V[i + 1];
-                }
-            }
-            // calculate price, delta, gamma, theta
-            price = V[0];
-            delta1 = (V10 - V11) / (S0 * (u - d));
-            gamma1 = ((V20 - V21) / (S0 * u * (u - d)) - (V21 - V22) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
-            theta1 = (V21 - price) / (2 * dt);
+            backwardInduction(N);
         }
         else if (method == "AverageBinomial")
         {
             BinomialEuropean tree_N = BinomialEuropean(S0, K, r, sigma, T, q, N, "Binomial", type);
             BinomialEuropean tree_Nplus1 = BinomialEuropean(S0, K, r, sigma, T, q, N + 1, "Binomial", type);
+            tree_N.setTiling(tile_width, tile_levels);
+            tree_N.setThreads(threads);
+            tree_N.setTruncation(truncation);
+            tree_Nplus1.setTiling(tile_width, tile_levels);
+            tree_Nplus1.setThreads(threads);
+            tree_Nplus1.setTruncation(truncation);
             tree_N.runSimulation();
             tree_Nplus1.runSimulation();
             price = (tree_N.getPrice() + tree_Nplus1.getPrice()) / 2;
@@ -143,39 +199,27 @@ public:
         }
         else if (method == "BBS")
         {
+            V.resize(N);
+            double S_temp = S0 * pow(u, N - 1);
+            int lo = truncation > 0 ? bandLow(N - 1, bandWidth()) : 0, hi = truncation > 0 ? bandHigh(N - 1, bandWidth()) : N - 1;
             for (int i = 0; i <= N - 1; i++)
             {
-                V.push_back(black_scholes_values(S_temp, K, dt, sigma, r, q)[type + "_price"]);
+                if (i >= lo && i <= hi)
+                    V[i] = black_scholes_values(S_temp, K, dt, sigma, r, q)[type + "_price"];
                 S_temp *= d_bar;
             }
-            for (int j = N - 2; j >= 0; j--)
-            {
-                if (j == 0)
-                {
-                    V10 = V[0];
-                    V11 = V[1];
-                }
-                if (j == 1)
-                {
-                    V20 = V[0];
-                    V21 = V[1];
-                    V22 = V[2];
-                }
-                for (int i = 0; i <= j; i++)
-                {
-                    V[i] = disc_p * V[i] + disc_1p * V[i + 1];
-                }
-            }
-            // calculate price, delta, gamma, theta
-            price = V[0];
-            delta1 = (V10 - V11) / (S0 * (u - d));
-            gamma1 = ((V20 - V21) / (S0 * u * (u - d)) - (V21 - V22) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
-            theta1 = (V21 - price) / (2 * dt);
+            backwardInduction(N - 1);
         }
         else if (method == "BBSR")
         {
             BinomialEuropean tree_N = BinomialEuropean(S0, K, r, sigma, T, q, N, "BBS", type);
             BinomialEuropean tree_halfN = BinomialEuropean(S0, K, r, sigma, T, q, N / 2, "BBS", type);
+            tree_N.setTiling(tile_width, tile_levels);
+            tree_N.setThreads(threads);
+            tree_N.setTruncation(truncation);
+            tree_halfN.setTiling(tile_width, tile_levels);
+            tree_halfN.setThreads(threads);
+            tree_halfN.setTruncation(truncation);
             tree_N.runSimulation();
             tree_halfN.runSimulation();
             price = 2 * tree_N.getPrice() - tree_halfN.getPrice();
@@ -2,20 +2,42 @@
 #pragma once
 
 #include "black_scholes.hpp"
+#include "black_scholes_implied_volatility.hpp"
 #include "binomial_option.hpp"
 #include "binomial_european.hpp"
+#include "lattice_cache.hpp"
 
+// European BBS trees already priced, shared by the N search and the volatility solvers
+inline LatticeCache& bbsrCache() {
+    static LatticeCache cache;
+    return cache;
+}
+
+double calculateOptionPrice_BBS(double sigma, double S0, double K, double r, double T, double q, int N, const std::string& type) {
+    LatticeKey key(S0, K, r, sigma, T, q, N, "BBS", type);
+    return bbsrCache().get(key, [&]() {
+        BinomialEuropean option(S0, K, r, sigma, T, q, N, "BBS", type);
+        option.runSimulation();
+        return LatticeResult{option.getPrice(), option.getDelta(), option.getGamma(), option.getTheta()};
+    }).price;
+}
+
+// BBSR(N) = 2 BBS(N) - BBS(N / 2), the same combination BinomialEuropean makes, from cached BBS trees
 double calculateOptionPrice_BBSR(double sigma, double S0, double K, double r, double T, double q, int N, const std::string& type) {
-    BinomialEuropean option(S0, K, r, sigma, T, q, N, "BBSR", type);  // Use the finest binomial tree model - BBSR
-    option.runSimulation();
-    return option.getPrice();
+    return 2 * calculateOptionPrice_BBS(sigma, S0, K, r, T, q, N, type) - calculateOptionPrice_BBS(sigma, S0, K, r, T, q, N / 2, type);
 }
 
-// Find proper N_fixed with tolerance 1e-4
+// Find proper N_fixed with tolerance 1e-4.
+// N doubles from 10; the fine BBS tree of one step is the coarse tree of the next, so every doubling prices
+// a single new tree. The error of BBSR(N) is estimated from the Richardson sequence as
+// |BBSR(N) - BBSR(N / 2)| / (2^p - 1), p the observed order clamped to [1, 2], and the search stops once it is below tol.
 int find_N_fixed(double sigma, double S0, double K, double r, double T, double q, const std::string& type, double tol = 1e-4) {
     int N = 10;  // initial time steps
-    double price_prev = calculateOptionPrice_BBSR(sigma, S0, K, r, T, q, N, type);  // Initial price
+    double bbs_coarse = calculateOptionPrice_BBS(sigma, S0, K, r, T, q, N / 2, type);
+    double bbs_fine = calculateOptionPrice_BBS(sigma, S0, K, r, T, q, N, type);
+    double price_prev = 2 * bbs_fine - bbs_coarse;  // Initial price
     double price_curr = 0.0;
+    double diff_prev = 0.0;
 
     std::cout << "Finding N_fixed...\n";
     std::cout << "N" << std::setw(30) << "Option Price (BBSR)\n";
@@ -23,51 +45,168 @@ int find_N_fixed(double sigma, double S0, double K, double r, double T, double q
 
     while (true) {
         N *= 2;  // Double the time steps
-        price_curr = calculateOptionPrice_BBSR(sigma, S0, K, r, T, q, N, type);  // calculate new option price
+        bbs_coarse = bbs_fine;
+        bbs_fine = calculateOptionPrice_BBS(sigma, S0, K, r, T, q, N, type);
+        price_curr = 2 * bbs_fine - bbs_coarse;  // calculate new option price
 
         std::cout << N << std::setw(30) << price_curr << std::endl;
 
-        // If the difference between two prices within tolerance 1e-4, stop iteration
-        if (std::fabs(price_curr - price_prev) < tol) {
-            std::cout << "N_fixed found: " << N << std::endl;
+        // Richardson estimate of the error left in price_curr
+        double diff = std::fabs(price_curr - price_prev);
+        double order = 1.0;
+        if (diff_prev > 0.0 && diff > 0.0) {
+            order = std::min(2.0, std::max(1.0, std::log2(diff_prev / diff)));
+        }
+        double error = diff / (std::pow(2.0, order) - 1.0);
+
+        // If the estimated error is within tolerance 1e-4, stop iteration
+        if (error < tol) {
+            std::cout << "N_fixed found: " << N << " (estimated error " << error << ")" << std::endl;
             return N;
         }
 
         // Update price, continue iteration
         price_prev = price_curr;
+        diff_prev = diff;
     }
 }
 
-double impliedVolatility_BBSR(double marketPrice, double S0, double K, double r, double T, double q, int N, const std::string& type, double tol = 1e-4, int max_iter = 100) {
-    double sigma0 = 0.05;  // initial volatility lower bound
-    double sigma1 = 1;  // initial volatility upper bound
-    double price0 = calculateOptionPrice_BBSR(sigma0, S0, K, r, T, q, N, type);
-    double price1 = calculateOptionPrice_BBSR(sigma1, S0, K, r, T, q, N, type);
-
-    std::cout << "Iterative vol value" << std::setw(20) << "Option value (BBSR)\n";
-    std::cout << sigma0 << std::setw(30) << price0 << std::endl;
-    std::cout << sigma1 << std::setw(30) << price1 << std::endl;
+// Result of an implied volatility solve: sigma, number of tree prices taken, and whether |price - target| < tol
+struct ImpliedVolResult {
+    double sigma;
+    int evaluations;
+    bool converged;
+};
+
+// Corrado-Miller approximation of the Black-Scholes implied volatility
+double corradoMillerVolatility(double price, double S0, double K, double r, double T, double q, const std::string& type) {
+    double S = S0 * std::exp(-q * T), X = K * std::exp(-r * T);
+    double call = (type == "put") ? price + S - X : price;  // put-call parity
+    double a = call - (S - X) / 2;
+    double root = std::sqrt(std::max(0.0, a * a - (S - X) * (S - X) / M_PI));
+    double sigma = std::sqrt(2 * M_PI / T) / (S + X) * (a + root);
+    return std::isfinite(sigma) && sigma > 0 ? sigma : 0.2;
+}
 
-    int iter = 0;
-    while (iter < max_iter) {
-        double sigma2 = sigma1 - (price1 - marketPrice) * (sigma1 - sigma0) / (price1 - price0);
-        double price2 = calculateOptionPrice_BBSR(sigma2, S0, K, r, T, q, N, type);
+// Starting point of the tree solvers: the exact Black-Scholes implied volatility of the quote, or Corrado-Miller
+// when the quote is outside the European bounds (an American put worth more than K e^(-rT))
+double impliedVolatilitySeed(double price, double S0, double K, double r, double T, double q, const std::string& type) {
+    double sigma = black_scholes_implied_volatility(price, S0, K, T, r, q, type == "put");
+    return std::isfinite(sigma) && sigma > 0 ? sigma : corradoMillerVolatility(price, S0, K, r, T, q, type);
+}
 
-        std::cout << sigma2 << std::setw(30) << price2 << std::endl;
+// Brent's method for f(sigma) = 0 on [a, b], f(a) < 0 < f(b); stops when |f| < tol or the bracket collapses
+template <typename F>
+ImpliedVolResult brentImpliedVolatility(F f, double a, double fa, double b, double fb, double tol, int evaluations, int max_eval) {
+    double c = a, fc = fa, d = b - a, e = d;
+    while (evaluations < max_eval) {
+        if ((fb > 0) == (fc > 0)) {
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (std::fabs(fc) < std::fabs(fb)) {
+            a = b; b = c; c = a;
+            fa = fb; fb = fc; fc = fa;
+        }
+        double xtol = 1e-12 * (1.0 + std::fabs(b)), m = (c - b) / 2;
+        if (std::fabs(fb) < tol || std::fabs(m) <= xtol) {
+            return {b, evaluations, std::fabs(fb) < tol};
+        }
+        if (std::fabs(e) >= xtol && std::fabs(fa) > std::fabs(fb)) {
+            // inverse quadratic interpolation, or secant when only two points are distinct
+            double s = fb / fa, p, qq;
+            if (a == c) {
+                p = 2 * m * s;
+                qq = 1 - s;
+            } else {
+                double t = fa / fc, v = fb / fc;
+                p = s * (2 * m * t * (t - v) - (b - a) * (v - 1));
+                qq = (t - 1) * (v - 1) * (s - 1);
+            }
+            if (p > 0) qq = -qq; else p = -p;
+            if (2 * p < std::min(3 * m * qq - std::fabs(xtol * qq), std::fabs(e * qq))) {
+                e = d;
+                d = p / qq;
+            } else {
+                d = m;
+                e = m;
+            }
+        } else {
+            d = m;
+            e = m;
+        }
+        a = b;
+        fa = fb;
+        b += std::fabs(d) > xtol ? d : (m > 0 ? xtol : -xtol);
+        fb = f(b);
+        evaluations++;
+    }
+    return {b, evaluations, std::fabs(fb) < tol};
+}
 
-        if (std::fabs(price2 - marketPrice) < tol) {
-            std::cout << "Implied volatility found: " << sigma2 << std::endl;
-            return sigma2;  // Volatility converges
+// Implied volatility of a tree pricer price(sigma), increasing in sigma, for the quote target.
+// Safeguarded Newton: the first step uses the analytic Black-Scholes vega at the seed, later ones the tree's own
+// vega from its last two prices (secant). A step that leaves the bracket of prices seen so far, or does not halve
+// |price - target|, hands over to Brent on that bracket, completed with lo / hi if one side is still missing.
+// No output; the caller decides what to report.
+template <typename Price>
+ImpliedVolResult solveImpliedVolatility(Price price, double target, double seed, double seed_vega, double tol = 1e-4,
+                                        int max_eval = 30, double lo = 1e-3, double hi = 3.0) {
+    int evaluations = 0;
+    auto f = [&](double sigma) { return price(sigma) - target; };
+    bool have_a = false, have_b = false;  // a: largest sigma seen below the quote, b: smallest above
+    double a = lo, fa = 0.0, b = hi, fb = 0.0;
+    double x = std::min(std::max(seed, lo), hi), fx = f(x), x_prev = 0.0, f_prev = 0.0;
+    evaluations++;
+    while (true) {
+        if (std::fabs(fx) < tol) {
+            return {x, evaluations, true};
         }
+        if (fx < 0 && (!have_a || x > a)) { a = x; fa = fx; have_a = true; }
+        if (fx > 0 && (!have_b || x < b)) { b = x; fb = fx; have_b = true; }
+        double vega = (evaluations == 1) ? seed_vega : (fx - f_prev) / (x - x_prev);
+        double x_new = x - fx / vega;
+        bool stalled = evaluations > 1 && std::fabs(fx) > 0.5 * std::fabs(f_prev);
+        if (!(vega > 0) || !(x_new > (have_a ? a : lo) && x_new < (have_b ? b : hi)) || stalled || evaluations >= max_eval) {
+            break;
+        }
+        x_prev = x;
+        f_prev = fx;
+        x = x_new;
+        fx = f(x);
+        evaluations++;
+    }
+    // Brent fallback on a bracket, failing if the quote is outside [price(lo), price(hi)]
+    if (!have_a) {
+        a = lo;
+        fa = f(a);
+        evaluations++;
+        if (fa > 0) return {lo, evaluations, false};
+    }
+    if (!have_b) {
+        b = hi;
+        fb = f(b);
+        evaluations++;
+        if (fb < 0) return {hi, evaluations, false};
+    }
+    return brentImpliedVolatility(f, a, fa, b, fb, tol, evaluations, max_eval);
+}
 
-        sigma0 = sigma1;
-        price0 = price1;
-        sigma1 = sigma2;
-        price1 = price2;
+// Implied volatility of a European quote on the BBSR tree
+ImpliedVolResult impliedVolatilitySolve_BBSR(double marketPrice, double S0, double K, double r, double T, double q, int N, const std::string& type, double tol = 1e-4, int max_eval = 30) {
+    double seed = impliedVolatilitySeed(marketPrice, S0, K, r, T, q, type);
+    double seed_vega = black_scholes_values(S0, K, T, seed, r, q)["vega"];
+    auto price = [&](double sigma) { return calculateOptionPrice_BBSR(sigma, S0, K, r, T, q, N, type); };
+    return solveImpliedVolatility(price, marketPrice, seed, seed_vega, tol, max_eval);
+}
 
-        iter++;
+double impliedVolatility_BBSR(double marketPrice, double S0, double K, double r, double T, double q, int N, const std::string& type, double tol = 1e-4, int max_iter = 100) {
+    ImpliedVolResult result = impliedVolatilitySolve_BBSR(marketPrice, S0, K, r, T, q, N, type, tol, max_iter);
+    if (!result.converged) {
+        std::cerr << "Failed to converge in " << result.evaluations << " tree evaluations." << std::endl;
+        return result.sigma;
     }
-
-    std::cerr << "Failed to converge in " << max_iter << " iterations." << std::endl;
-    return sigma1;  // return the final result
-}
\ No newline at end of file
+    std::cout << "Implied volatility found: " << result.sigma << " (" << result.evaluations << " BBSR tree evaluations)" << std::endl;
+    return result.sigma;
+}
@@ -48,4 +48,17 @@ std::map<std::string, double> black_scholes_values(double S, double K, double T,
         {"gamma", gamma}};
 }
 
+// Price alone, for callers evaluating many nodes (the map above allocates on every call)
+inline double black_scholes_price(double S, double K, double T, double sigma, double r, double q, bool isPut)
+{
+    using boost::math::normal;
+    normal norm_dist(0.0, 1.0);
+
+    double d1 = (std::log(S / K) + (r - q + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
+    double d2 = d1 - sigma * std::sqrt(T);
+    if (isPut)
+        return K * std::exp(-r * T) * cdf(norm_dist, -d2) - S * std::exp(-q * T) * cdf(norm_dist, -d1);
+    return S * std::exp(-q * T) * cdf(norm_dist, d1) - K * std::exp(-r * T) * cdf(norm_dist, d2);
+}
+
 #endif
\ No newline at end of file
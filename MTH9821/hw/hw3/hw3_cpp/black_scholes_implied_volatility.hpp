@@ -0,0 +1,161 @@
+#ifndef BlackScholesImpliedVolatility_hpp
+#define BlackScholesImpliedVolatility_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <boost/math/distributions/normal.hpp>
+#include <boost/math/special_functions/erf.hpp>
+
+// Black-Scholes implied volatility to machine precision without a pricer in the loop, after Jaeckel,
+// "Let's Be Rational" (2015). Prices are normalised to the out of the money call
+//   b(x, s) = e^(x/2) N(x/s + s/2) - e^(-x/2) N(x/s - s/2),   x = ln(F/K) <= 0,   s = sigma sqrt(T)
+// and s is found by Householder steps of third order on one of three transforms of b, chosen by where the
+// quote lies relative to the inflexion point of b(s): 1/ln(b) below it, b in the middle, ln(b_max - b) above.
+
+// e^(z^2) erfc(z) for z >= 0, without the underflow of erfc
+inline double erfcx(double z)
+{
+    if (z < 26.0)
+    {
+        double zz = z * z;
+        return std::exp(zz) * (1.0 + std::fma(z, z, -zz)) * std::erfc(z);
+    }
+    double w = 1.0 / (2.0 * z * z);
+    double series = 1.0 - w * (1.0 - 3.0 * w * (1.0 - 5.0 * w * (1.0 - 7.0 * w * (1.0 - 9.0 * w * (1.0 - 11.0 * w)))));
+    return series / (z * std::sqrt(M_PI));
+}
+
+// b(x, s) for x <= 0. Below the inflexion point both terms are tiny and close, so the difference is taken
+// between scaled complementary error functions, whose common factor exp(-(h^2 + t^2) / 2) is pulled out.
+inline double normalised_black(double x, double s)
+{
+    if (s <= 0.0)
+        return 0.0;
+    double h = x / s, t = s / 2;
+    if (h + t < 0.0)
+        return 0.5 * std::exp(-0.5 * (h * h + t * t)) * (erfcx(-(h + t) / M_SQRT2) - erfcx(-(h - t) / M_SQRT2));
+    return 0.5 * std::exp(x / 2) * std::erfc(-(h + t) / M_SQRT2) - 0.5 * std::exp(-x / 2) * std::erfc(-(h - t) / M_SQRT2);
+}
+
+// b_max - b(x, s) = e^(x/2) N(-x/s - s/2) + e^(-x/2) N(x/s - s/2), computed without the cancellation
+inline double normalised_black_complement(double x, double s)
+{
+    double h = x / s, t = s / 2;
+    return 0.5 * std::exp(x / 2) * std::erfc((h + t) / M_SQRT2) + 0.5 * std::exp(-x / 2) * std::erfc(-(h - t) / M_SQRT2);
+}
+
+// db/ds
+inline double normalised_vega(double x, double s)
+{
+    double h = x / s, t = s / 2;
+    return std::exp(-0.5 * (h * h + t * t)) / std::sqrt(2 * M_PI);
+}
+
+// Implied volatility of a European price, NaN when the price is outside the no-arbitrage bounds
+inline double black_scholes_implied_volatility(double price, double S, double K, double T, double r, double q, bool isPut)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    double F = S * std::exp((r - q) * T);
+    double x = std::log(F / K);
+    double beta = price / (std::exp(-r * T) * std::sqrt(F * K));
+
+    // in the money: remove the intrinsic value, leaving the out of the money option of the other type (parity);
+    // an out of the money put at x is the out of the money call at -x
+    double theta = isPut ? -1.0 : 1.0;
+    if (theta * x > 0.0)
+        beta -= theta * (std::exp(x / 2) - std::exp(-x / 2));
+    x = -std::fabs(x);
+    double b_max = std::exp(x / 2);
+    if (!(beta >= 0.0) || !(beta < b_max))
+        return nan;
+    if (beta == 0.0)
+        return 0.0;
+    // at the forward b(0, s) = erf(s / (2 sqrt(2))) is inverted exactly; the branch points below all collapse to 0
+    if (x == 0.0)
+        return 2 * M_SQRT2 * boost::math::erf_inv(beta) / std::sqrt(T);
+
+    // branch points: tangent of b at the inflexion point s_c, crossing 0 at s_l and b_max at s_u
+    double s_c = std::sqrt(-2 * x);
+    double b_c = normalised_black(x, s_c), v_c = normalised_vega(x, s_c);
+    double s_l = s_c - b_c / v_c, s_u = s_c + (b_max - b_c) / v_c;
+    double b_l = s_l > 0.0 ? normalised_black(x, s_l) : 0.0;
+    double b_u = normalised_black(x, s_u);
+
+    // objective f(s) = phi(b(s)) - phi(beta) with phi increasing
+    int branch;
+    double s;
+    if (beta < b_l)
+    {
+        // 1/ln(b) is nearly quadratic in s towards 0
+        branch = 0;
+        s = s_l * std::sqrt(std::log(b_l) / std::log(beta));
+    }
+    else if (beta > b_u)
+    {
+        // b_max - b ~ (e^(x/2) + e^(-x/2)) N(-s/2) for large s
+        branch = 2;
+        boost::math::normal norm_dist(0.0, 1.0);
+        double tail = (b_max - beta) / (b_max + 1 / b_max);
+        s = std::max(s_u, -2 * quantile(norm_dist, std::min(tail, 0.5)));
+    }
+    else
+    {
+        branch = 1;
+        if (beta < b_c)
+            s = s_l > 0.0 ? s_l + (s_c - s_l) * (beta - b_l) / (b_c - b_l) : s_c * beta / b_c;
+        else
+            s = s_c + (s_u - s_c) * (beta - b_c) / (b_u - b_c);
+    }
+    double target = branch == 0 ? 1 / std::log(beta) : branch == 1 ? beta : -std::log(b_max - beta);
+
+    for (int iteration = 0; iteration < 10; iteration++)
+    {
+        double b = normalised_black(x, s), v = normalised_vega(x, s);
+        if (branch == 0 && !(b > 0.0 && v > 0.0))
+        {
+            // underflow below the quote: move up towards the branch point
+            s = (s + s_l) / 2;
+            continue;
+        }
+        // f and phi^(k)(b) v^k, through the ratios v / b and v / (b_max - b) that stay finite where b underflows
+        double f, D1, D2, D3;
+        if (branch == 0)
+        {
+            double L = std::log(b), lambda = v / b;
+            f = 1 / L - target;
+            D1 = -lambda / (L * L);
+            D2 = (L + 2) * lambda * lambda / (L * L * L);
+            D3 = -(2 * L * L + 6 * L + 6) * lambda * lambda * lambda / (L * L * L * L);
+        }
+        else if (branch == 1)
+        {
+            f = b - target;
+            D1 = v;
+            D2 = D3 = 0.0;
+        }
+        else
+        {
+            double c = normalised_black_complement(x, s), mu = v / c;
+            f = -std::log(c) - target;
+            D1 = mu;
+            D2 = mu * mu;
+            D3 = 2 * mu * mu * mu;
+        }
+        // b''/b' and b'''/b' of the normalised Black function
+        double d2 = x * x / (s * s * s) - s / 4;
+        double d3 = d2 * d2 - 3 * x * x / (s * s * s * s) - 0.25;
+        double f1 = D1, f2 = D2 + D1 * d2, f3 = D3 + 3 * D2 * d2 + D1 * d3;
+        double nu = -f / f1, gamma = f2 / f1, delta = f3 / f1;
+        double step = nu * (1 + gamma * nu / 2) / (1 + nu * (gamma + delta * nu / 6));
+        if (!std::isfinite(step))
+            break;
+        // keep the iterate positive
+        s = step < -s ? s / 2 : s + step;
+        if (std::fabs(step) <= 4 * std::numeric_limits<double>::epsilon() * s)
+            break;
+    }
+    return s / std::sqrt(T);
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef ImpliedVolatilitySurface_hpp
+#define ImpliedVolatilitySurface_hpp
+
+#include "binomial_implied_volatility.hpp"
+#include "binomial_american.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One market quote of the chain
+struct OptionQuote {
+    double K, T, price;
+    std::string type;  // "put" or "call"
+};
+
+// Implied vols of a chain on the grid of its distinct expiries x strikes
+struct VolSurface {
+    std::vector<double> expiries, strikes;   // ascending grid axes
+    std::vector<double> vols;                // vols[e * strikes.size() + k], NAN where no quote converged (puts win over calls)
+    std::vector<double> quote_vols;          // per quote, in chain order
+    std::vector<int> evaluations;            // BBSR tree prices per quote
+    std::vector<std::size_t> failures;       // chain indices of the quotes that did not converge
+
+    double vol(std::size_t e, std::size_t k) const { return vols[e * strikes.size() + k]; }
+};
+
+// Implied vols of every quote on BBSR trees with N steps (American or European), solved on `threads` threads.
+// Quotes are grouped by expiry and type, one group per task. A group is solved outward from the strike closest
+// to S0, each strike seeded as below, with the Black-Scholes vega at the seed for the first Newton step.
+VolSurface buildVolSurface(const std::vector<OptionQuote>& chain, double S0, double r, double q, int N, bool american,
+                           int threads = std::max(1u, std::thread::hardware_concurrency()), double tol = 1e-4) {
+    VolSurface surface;
+    for (const OptionQuote& quote : chain) {
+        surface.expiries.push_back(quote.T);
+        surface.strikes.push_back(quote.K);
+    }
+    for (std::vector<double>* axis : {&surface.expiries, &surface.strikes}) {
+        std::sort(axis->begin(), axis->end());
+        axis->erase(std::unique(axis->begin(), axis->end()), axis->end());
+    }
+    surface.quote_vols.assign(chain.size(), NAN);
+    surface.evaluations.assign(chain.size(), 0);
+
+    // groups of quote indices sharing expiry and type, by strike
+    std::vector<std::vector<std::size_t>> groups;
+    for (double T : surface.expiries) {
+        for (const char* type : {"put", "call"}) {
+            std::vector<std::size_t> group;
+            for (std::size_t i = 0; i < chain.size(); i++) {
+                if (chain[i].T == T && chain[i].type == type) group.push_back(i);
+            }
+            std::sort(group.begin(), group.end(), [&](std::size_t a, std::size_t b) { return chain[a].K < chain[b].K; });
+            if (!group.empty()) groups.push_back(group);
+        }
+    }
+
+    auto solveGroup = [&](const std::vector<std::size_t>& group) {
+        std::size_t atm = 0;
+        for (std::size_t k = 1; k < group.size(); k++) {
+            if (std::fabs(chain[group[k]].K - S0) < std::fabs(chain[group[atm]].K - S0)) atm = k;
+        }
+        // the money strike first, then outwards on either side
+        std::vector<std::size_t> order{atm};
+        for (std::size_t k = atm + 1; k < group.size(); k++) order.push_back(k);
+        for (std::size_t k = atm; k-- > 0;) order.push_back(k);
+        for (std::size_t n = 0; n < order.size(); n++) {
+            std::size_t k = order[n], i = group[k];
+            const OptionQuote& quote = chain[i];
+            // European quotes: their Black-Scholes implied vol, which the tree reproduces to its discretization error.
+            // American ones: the neighbour's tree vol, moved by the difference of the two quotes' Black-Scholes vols
+            double seed = impliedVolatilitySeed(quote.price, S0, quote.K, r, quote.T, q, quote.type);
+            if (american && n > 0) {
+                // k != atm here, so the neighbour towards the money strike is inside the group
+                std::size_t neighbour = group[k > atm ? k - 1 : k + 1];
+                if (!std::isnan(surface.quote_vols[neighbour])) {
+                    const OptionQuote& next_to = chain[neighbour];
+                    double shift = seed - impliedVolatilitySeed(next_to.price, S0, next_to.K, r, next_to.T, q, next_to.type);
+                    seed = surface.quote_vols[neighbour] + shift > 0 ? surface.quote_vols[neighbour] + shift : surface.quote_vols[neighbour];
+                }
+            }
+            double seed_vega = black_scholes_values(S0, quote.K, quote.T, seed, r, q)["vega"];
+            auto price = [&](double sigma) {
+                if (!american) return calculateOptionPrice_BBSR(sigma, S0, quote.K, r, quote.T, q, N, quote.type);
+                BinomialAmerican tree(S0, quote.K, r, sigma, quote.T, q, N, "BBSR", quote.type);
+                tree.runSimulation();
+                return tree.getPrice();
+            };
+            ImpliedVolResult result = solveImpliedVolatility(price, quote.price, seed, seed_vega, tol);
+            surface.evaluations[i] = result.evaluations;
+            if (result.converged) surface.quote_vols[i] = result.sigma;
+        }
+    };
+
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]() {
+        for (std::size_t g = next++; g < groups.size(); g = next++) solveGroup(groups[g]);
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < std::min<int>(threads, groups.size()); t++) pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool) thread.join();
+
+    // dense grid, calls first so that puts overwrite them where both are quoted
+    surface.vols.assign(surface.expiries.size() * surface.strikes.size(), NAN);
+    for (const char* type : {"call", "put"}) {
+        for (std::size_t i = 0; i < chain.size(); i++) {
+            if (chain[i].type != type || std::isnan(surface.quote_vols[i])) continue;
+            std::size_t e = std::lower_bound(surface.expiries.begin(), surface.expiries.end(), chain[i].T) - surface.expiries.begin();
+            std::size_t k = std::lower_bound(surface.strikes.begin(), surface.strikes.end(), chain[i].K) - surface.strikes.begin();
+            surface.vols[e * surface.strikes.size() + k] = surface.quote_vols[i];
+        }
+    }
+    for (std::size_t i = 0; i < chain.size(); i++) {
+        if (std::isnan(surface.quote_vols[i])) surface.failures.push_back(i);
+    }
+    return surface;
+}
+
+#endif
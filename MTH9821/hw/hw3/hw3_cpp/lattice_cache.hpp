@@ -0,0 +1,128 @@
+#ifndef LatticeCache_hpp
+#define LatticeCache_hpp
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Price and Greeks of one tree run
+struct LatticeResult
+{
+    double price, delta, gamma, theta;
+};
+
+// Tree parameters with the doubles quantized to 40 significant bits (relative 1e-12), so that values
+// reached by different arithmetic paths (e.g. a secant step landing on an earlier volatility) share a key
+struct LatticeKey
+{
+    long long S0, K, r, sigma, T, q;
+    int N;
+    std::string method, type;
+
+    static long long quantize(double x)
+    {
+        int exponent;
+        double mantissa = std::frexp(x, &exponent);
+        return std::llround(std::ldexp(mantissa, 40)) * 4096 + (exponent + 2048);
+    }
+
+    LatticeKey(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, const std::string &method_, const std::string &type_)
+        : S0(quantize(S0_)), K(quantize(K_)), r(quantize(r_)), sigma(quantize(sigma_)), T(quantize(T_)), q(quantize(q_)),
+          N(N_), method(method_), type(type_)
+    {
+    }
+
+    bool operator==(const LatticeKey &other) const
+    {
+        return S0 == other.S0 && K == other.K && r == other.r && sigma == other.sigma && T == other.T && q == other.q &&
+               N == other.N && method == other.method && type == other.type;
+    }
+};
+
+struct LatticeKeyHash
+{
+    std::size_t operator()(const LatticeKey &key) const
+    {
+        std::size_t h = std::hash<std::string>()(key.method) ^ (std::hash<std::string>()(key.type) << 1);
+        for (long long x : {key.S0, key.K, key.r, key.sigma, key.T, key.q, (long long)key.N})
+            h = h * 1000003 ^ std::hash<long long>()(x);
+        return h;
+    }
+};
+
+// Bounded least recently used memo of tree results, one cache per pricer (the key does not name the tree class).
+// get() is safe to call from several threads; the tree itself runs outside the lock, so two threads missing on
+// the same key may both price it and the second insert is dropped.
+class LatticeCache
+{
+private:
+    typedef std::list<std::pair<LatticeKey, LatticeResult>> Entries;
+    std::size_t capacity;
+    Entries entries; // most recently used first
+    std::unordered_map<LatticeKey, Entries::iterator, LatticeKeyHash> index;
+    std::size_t hit_count = 0, miss_count = 0;
+    mutable std::mutex mutex;
+
+public:
+    explicit LatticeCache(std::size_t capacity_ = 4096) : capacity(capacity_) {}
+
+    // cached result for key, or price() stored under key
+    template <typename Price>
+    LatticeResult get(const LatticeKey &key, Price price)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = index.find(key);
+            if (found != index.end())
+            {
+                hit_count++;
+                entries.splice(entries.begin(), entries, found->second);
+                return found->second->second;
+            }
+            miss_count++;
+        }
+        LatticeResult result = price();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (capacity > 0 && index.find(key) == index.end())
+        {
+            entries.emplace_front(key, result);
+            index.emplace(key, entries.begin());
+            if (entries.size() > capacity)
+            {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+        }
+        return result;
+    }
+
+    std::size_t hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hit_count;
+    }
+    std::size_t misses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return miss_count;
+    }
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+        hit_count = miss_count = 0;
+    }
+};
+
+#endif
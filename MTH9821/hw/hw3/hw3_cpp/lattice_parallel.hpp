@@ -0,0 +1,100 @@
+#ifndef LatticeParallel_hpp
+#define LatticeParallel_hpp
+
+#include "lattice_kernel.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Reusable barrier for a fixed number of threads
+class LatticeBarrier
+{
+private:
+    std::mutex m;
+    std::condition_variable cv;
+    int count;
+    int waiting = 0;
+    unsigned long generation = 0;
+
+public:
+    explicit LatticeBarrier(int count_) : count(count_) {}
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m);
+        unsigned long arrived = generation;
+        if (++waiting == count)
+        {
+            waiting = 0;
+            generation++;
+            cv.notify_all();
+        }
+        else
+        {
+            cv.wait(lock, [&]() { return arrived != generation; });
+        }
+    }
+};
+
+// Backward induction from level top down to level bottom on `threads` threads.
+// Every `levels` time steps the nodes of the band's last level are split into one contiguous chunk per thread.
+// Each thread copies its chunk plus the span * levels nodes to its right (everything the chunk depends on
+// within the band) into a private buffer, steps it down the band on its own and writes the chunk back, so the
+// threads meet at two barriers per band instead of one per level. The overlap is recomputed by both neighbours,
+// about span * levels^2 / 2 extra nodes per chunk and band. step(j, v, lo, hi) is the same one-level update
+// the tiled sweep uses, so the result is bit-identical to the serial induction.
+template <typename Step>
+void parallel_induction(double *V, int top, int bottom, int span, int threads, int levels, Step step)
+{
+    const int min_chunk = 256; // below this a thread costs more in barriers than it saves
+    LatticeBarrier barrier(threads);
+    auto worker = [&](int t) {
+        FlushDenormals ftz; // the floating point control register is per thread
+        LatticeBuffer local;
+        for (int h = top; h > bottom; h -= levels)
+        {
+            int steps = std::min(levels, h - bottom);
+            int nodes = span * (h - steps) + 1;
+            int chunk = std::max((nodes + threads - 1) / threads, min_chunk);
+            int c0 = std::min(nodes, t * chunk), c1 = std::min(nodes, c0 + chunk);
+            if (c0 < c1)
+            {
+                local.assign(V + c0, V + std::min(c1 + span * steps, span * h + 1));
+                for (int s = 1; s <= steps; s++)
+                {
+                    step(h - s, local.data(), c0, std::min(c1 - 1 + span * (steps - s), span * (h - s)));
+                }
+            }
+            barrier.wait();
+            if (c0 < c1)
+            {
+                std::copy(local.begin(), local.begin() + (c1 - c0), V + c0);
+            }
+            barrier.wait();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++)
+    {
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread &th : pool)
+    {
+        th.join();
+    }
+}
+
+inline void binomial_induction_parallel(double *V, int top, int bottom, double disc_p, double disc_1p,
+                                        const BinomialExerciseTable *exercise, int threads, int levels)
+{
+    parallel_induction(V, top, bottom, 1, threads, levels, binomial_range_step(disc_p, disc_1p, exercise));
+}
+
+inline void trinomial_induction_parallel(double *V, int top, int bottom, double disc_p_u, double disc_p_m, double disc_p_d,
+                                         const TrinomialExerciseTable *exercise, int threads, int levels)
+{
+    parallel_induction(V, top, bottom, 2, threads, levels, trinomial_range_step(disc_p_u, disc_p_m, disc_p_d, exercise));
+}
+
+#endif
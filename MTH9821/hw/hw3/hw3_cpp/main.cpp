@@ -1,6 +1,7 @@
 #include "binomial_european.hpp"
 #include "binomial_american.hpp"
 #include "binomial_option.hpp"
+#include "binomial_control_variate.hpp"
 #include "binomial_implied_volatility.hpp"
 
 void runBinomialCalculator(BinomialOption& binop, double V_actual, double D_actual, double G_actual, double T_actual, int N){
@@ -13,14 +14,13 @@ void runBinomialCalculator(BinomialOption& binop, double V_actual, double D_actu
     std::cout << delta << "\t" << std::abs(delta - D_actual)<< "\t" << gamma << "\t" <<std::abs(gamma - G_actual)<< "\t" << theta << "\t" << std::abs(theta - T_actual) << std::endl;
 }
 
-// FOR VARIANCE REDUCTION ONLY
-void runBinomialCalculator_VR(BinomialOption& binop, BinomialOption& binop2, double V_actual, double D_actual, double G_actual, double T_actual, double V_BS, double D_BS, double G_BS, double T_BS, int N){
+// FOR VARIANCE REDUCTION ONLY: American tree - European tree + Black-Scholes, both trees in one sweep
+void runBinomialCalculator_VR(BinomialControlVariate& binop, double V_actual, double D_actual, double G_actual, double T_actual, int N){
     binop.runSimulation();
-    binop2.runSimulation();
-    double price = binop.getPrice() - binop2.getPrice() + V_BS;
-    double delta = binop.getDelta() - binop2.getDelta() + D_BS;
-    double gamma = binop.getGamma() - binop2.getGamma() + G_BS;
-    double theta = binop.getTheta() - binop2.getTheta() + T_BS;
+    double price = binop.getPrice();
+    double delta = binop.getDelta();
+    double gamma = binop.getGamma();
+    double theta = binop.getTheta();
     std::cout << N << "\t" << price << "\t" << std::abs(price - V_actual) << "\t" << N * std::abs(price - V_actual) << "\t" << N * N * std::abs(price - V_actual) << "\t";
     std::cout << delta << "\t" << std::abs(delta - D_actual)<< "\t" << gamma << "\t" <<std::abs(gamma - G_actual)<< "\t" << theta << "\t" << std::abs(theta - T_actual) << std::endl;
 }
@@ -127,6 +127,7 @@ int main()
     // AMERICAN OPTIONS
     std::cout << "\n-AMERICAN OPTION\n"<< std::endl;
     BinomialAmerican binomial_american(S0, K, r, sigma, T, q, 10000, "AverageBinomial", type);
+    binomial_american.setThreads(std::max(1u, std::thread::hardware_concurrency())); // reference price, identical on any thread count
     binomial_american.runSimulation();
     double V_Exact = binomial_american.getPrice();
     double D_Exact = binomial_american.getDelta();
@@ -159,9 +160,8 @@ int main()
         std::cout << "N\tprice\t\tabs error\tN * abs error\tN^2 * abs error\tdelta\t\tD abs error\tgamma\t\tG abs error\ttheta\t\tT abs error\t" << std::endl;
         for (int N : Ns)
         {
-            BinomialAmerican binomial_american(S0, K, r, sigma, T, q, N, method, type);
-            BinomialEuropean binomial_european(S0, K, r, sigma, T, q, N, method, type);
-            runBinomialCalculator_VR(binomial_american, binomial_european, V_Exact, D_Exact, G_Exact, T_Exact, V_BS, D_BS, G_BS, T_BS, N);
+            BinomialControlVariate binomial_cv(S0, K, r, sigma, T, q, N, method, type);
+            runBinomialCalculator_VR(binomial_cv, V_Exact, D_Exact, G_Exact, T_Exact, N);
         }
     }
 
@@ -181,6 +181,7 @@ int main()
         // Calculate implied volatility
         double impliedVol = impliedVolatility_BBSR(marketPrice, S0, K, r, T, q, N_fixed, type);
         std::cout << "Implied Volatility (BBSR Model): " << impliedVol << std::endl;
+        std::cout << "BBS trees reused from the cache: " << bbsrCache().hits() << " of " << bbsrCache().hits() + bbsrCache().misses() << std::endl;
 
     }
 
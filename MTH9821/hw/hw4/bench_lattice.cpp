@@ -0,0 +1,384 @@
+// Timing of the lattice kernels, separate from main.cpp so the homework tables stay fast to produce.
+// Build: g++ -std=c++17 -O3 -march=native bench_lattice.cpp -o bench_lattice
+#include "binomial_european.hpp"
+#include "binomial_american.hpp"
+#include "trinomial_european.hpp"
+#include "trinomial_american.hpp"
+#include "binomial_batch.hpp"
+#include "lattice_tree.hpp"
+#include "binomial_control_variate.hpp"
+#include "trinomial_control_variate.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+// wall time in milliseconds of the best of `repeat` calls of f
+template <typename F>
+double time_ms(F f, int repeat = 3)
+{
+    double best = 1e300;
+    for (int k = 0; k < repeat; k++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+void bench_binomial_rerun()
+{
+    std::cout << "\n-BINOMIAL KERNEL (reused buffers, multiplicative spots, exercise table)\n" << std::endl;
+    std::cout << "N\ttree\t\tprice\t\trerun price\ttime (ms)" << std::endl;
+    for (int N : {10000, 100000})
+    {
+        BinomialEuropean european(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, "Binomial", "put");
+        BinomialAmerican american(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, "Binomial", "put");
+        int repeat = N >= 100000 ? 1 : 3;
+        double ms_eu = time_ms([&]() { european.runSimulation(); }, repeat);
+        double eu_price = european.getPrice();
+        european.runSimulation();
+        std::cout << N << "\tEuropean\t" << eu_price << "\t" << european.getPrice() << "\t" << ms_eu << std::endl;
+        double ms_am = time_ms([&]() { american.runSimulation(); }, repeat);
+        double am_price = american.getPrice();
+        american.runSimulation();
+        std::cout << N << "\tAmerican\t" << am_price << "\t" << american.getPrice() << "\t" << ms_am << std::endl;
+    }
+}
+
+// Full backward induction over N levels of synthetic leaves with each instruction set, the scalar run being the original loop
+void bench_simd_steps(int N)
+{
+    std::cout << "\n-SIMD BACKWARD STEP, N = " << N << "\n" << std::endl;
+    std::cout << "kernel			scalar (ms)	AVX2 (ms)	AVX-512 (ms)	max |diff|" << std::endl;
+    LatticeBuffer leaves(2 * N + 1), exercise(2 * N + 1), V;
+    for (int i = 0; i <= 2 * N; i++)
+    {
+        double S = 41.0 * std::exp(0.24 * std::sqrt(3.0 / N) * (N - i));
+        leaves[i] = std::max(43.0 - S, 0.0);
+        exercise[i] = std::max(43.0 - 1.001 * S, 0.0);
+    }
+    const char *names[] = {"binomial European", "binomial American", "trinomial European", "trinomial American"};
+    for (int kernel = 0; kernel < 4; kernel++)
+    {
+        double ms[3] = {0.0, 0.0, 0.0};
+        double root[3] = {0.0, 0.0, 0.0};
+        for (int level = SIMD_SCALAR; level <= SIMD_AVX512; level++)
+        {
+            set_simd_level(SimdLevel(level));
+            if (active_simd_level() != level)
+                continue;
+            ms[level] = time_ms([&]() {
+                V.assign(leaves.begin(), leaves.end());
+                for (int j = N - 1; j >= 0; j--)
+                {
+                    if (kernel == 0)
+                        binomial_step(V.data(), j, 0.4985, 0.4995);
+                    else if (kernel == 1)
+                        binomial_step_american(V.data(), exercise.data() + N - j, j, 0.4985, 0.4995);
+                    else if (kernel == 2)
+                        trinomial_step(V.data(), j, 0.1660, 0.6663, 0.1667);
+                    else
+                        trinomial_step_american(V.data(), exercise.data() + N - j, j, 0.1660, 0.6663, 0.1667);
+                }
+            });
+            root[level] = V[0];
+        }
+        set_simd_level(SIMD_AVX512);
+        double diff = std::max(ms[1] > 0 ? std::abs(root[1] - root[0]) : 0.0, ms[2] > 0 ? std::abs(root[2] - root[0]) : 0.0);
+        std::cout << names[kernel] << "\t" << (kernel % 2 ? "" : "\t") << ms[0] << "\t" << ms[1] << "\t" << ms[2] << "\t" << std::scientific << diff << std::fixed << std::endl;
+    }
+}
+
+// Untiled against cache blocked induction on one tree, the prices have to agree bit for bit
+template <typename Tree>
+void bench_tiling_case(const char *name, Tree &tree, int N, int width, int levels)
+{
+    tree.setTiling(0, 0);
+    double ms_plain = time_ms([&]() { tree.runSimulation(); }, 1);
+    double plain = tree.getPrice();
+    tree.setTiling(width, levels);
+    double ms_tiled = time_ms([&]() { tree.runSimulation(); }, 1);
+    std::cout << name << "\t" << N << "\t" << ms_plain << "\t" << ms_tiled << "\t" << (plain == tree.getPrice() ? "yes" : "NO") << std::endl;
+}
+
+void bench_tiling(int N_binomial, int N_trinomial, int width, int levels)
+{
+    std::cout << "\n-CACHE BLOCKED INDUCTION, tiles of " << width << " nodes x " << levels << " levels\n" << std::endl;
+    std::cout << "tree\t\t\tN\tuntiled (ms)\ttiled (ms)\tidentical" << std::endl;
+    BinomialEuropean binomial_european(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N_binomial, "Binomial", "put");
+    BinomialAmerican binomial_american(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N_binomial, "Binomial", "put");
+    TrinomialEuropean trinomial_european(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N_trinomial, "Trinomial", "put");
+    TrinomialAmerican trinomial_american(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N_trinomial, "Trinomial", "put");
+    bench_tiling_case("binomial European", binomial_european, N_binomial, width, levels);
+    bench_tiling_case("binomial American", binomial_american, N_binomial, width, levels);
+    bench_tiling_case("trinomial European", trinomial_european, N_trinomial, width, levels);
+    bench_tiling_case("trinomial American", trinomial_american, N_trinomial, width, levels);
+}
+
+// One American tree priced with 1, 2, 4, ... threads up to the core count, prices have to match the serial run
+template <typename Tree>
+void bench_threads_case(const char *name, Tree &tree)
+{
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    tree.setThreads(1);
+    double ms_serial = time_ms([&]() { tree.runSimulation(); }, 1);
+    double serial = tree.getPrice();
+    std::cout << name << "\t1\t" << ms_serial << "\t1.00\tyes" << std::endl;
+    for (int n = 2; n <= std::max(cores, 4); n *= 2)
+    {
+        tree.setThreads(n);
+        double ms = time_ms([&]() { tree.runSimulation(); }, 1);
+        std::cout << name << "\t" << n << "\t" << ms << "\t" << std::setprecision(2) << ms_serial / ms << std::setprecision(6)
+                  << "\t" << (serial == tree.getPrice() ? "yes" : "NO") << std::endl;
+    }
+}
+
+void bench_threads(int N)
+{
+    std::cout << "\n-MULTITHREADED INDUCTION, N = " << N << ", " << std::thread::hardware_concurrency() << " cores\n" << std::endl;
+    std::cout << "tree\t\t\tthreads\ttime (ms)\tspeedup\tidentical" << std::endl;
+    BinomialAmerican binomial_american(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, "Binomial", "put");
+    TrinomialAmerican trinomial_american(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, "Trinomial", "put");
+    bench_threads_case("binomial American", binomial_american);
+    bench_threads_case("trinomial American", trinomial_american);
+}
+
+// A strip of American puts on one underlying, one BinomialAmerican per strike against a single batch lattice.
+// A block of 8 strikes holds 64 (N + 1) bytes per level: at N = 200 it stays in L1, at N = 2000 it does not.
+void bench_batch(int N)
+{
+    std::cout << "\n-MULTI-STRIKE AMERICAN BATCH, N = " << N << "\n" << std::endl;
+    std::cout << "strikes\tper tree (ms)\tbatch (ms)\toptions/s\tspeedup\tidentical" << std::endl;
+    for (int count : {1, 4, 8, 12, 64, 512})
+    {
+        std::vector<double> strikes(count);
+        for (int k = 0; k < count; k++)
+            strikes[k] = 30.0 + 25.0 * k / count;
+        std::vector<double> single(count);
+        double ms_single = time_ms([&]() {
+            for (int k = 0; k < count; k++)
+            {
+                BinomialAmerican tree(41.0, strikes[k], 0.035, 0.24, 1.0, 0.0075, N, "Binomial", "put");
+                tree.runSimulation();
+                single[k] = tree.getPrice();
+            }
+        });
+        BinomialAmericanBatch batch(41.0, strikes, 0.035, 0.24, 1.0, 0.0075, N, "Binomial", "put");
+        double ms_batch = time_ms([&]() { batch.runSimulation(); });
+        std::cout << count << "\t" << ms_single << "\t" << ms_batch << "\t" << std::setprecision(0) << count / ms_batch * 1000.0
+                  << std::setprecision(2) << "\t" << ms_single / ms_batch << std::setprecision(6) << "\t" << (single == batch.getPrices() ? "yes" : "NO") << std::endl;
+    }
+}
+
+// Many small trees built and run from scratch, as in an implied volatility or calibration loop:
+// string dispatched classes against the compile-time Tree with the same type, style and method
+template <typename Strings, typename Typed>
+void bench_dispatch_case(const char *name, const char *method, int N, int count)
+{
+    double sum_strings = 0.0, sum_typed = 0.0;
+    double ms_strings = time_ms([&]() {
+        sum_strings = 0.0;
+        for (int k = 0; k < count; k++)
+        {
+            Strings tree(41.0, 43.0 + 1e-3 * k, 0.035, 0.24, 1.0, 0.0075, N, method, "put");
+            tree.runSimulation();
+            sum_strings += tree.getPrice();
+        }
+    });
+    double ms_typed = time_ms([&]() {
+        sum_typed = 0.0;
+        for (int k = 0; k < count; k++)
+        {
+            Typed tree(41.0, 43.0 + 1e-3 * k, 0.035, 0.24, 1.0, 0.0075, N);
+            tree.runSimulation();
+            sum_typed += tree.getPrice();
+        }
+    });
+    std::cout << name << "\t" << N << "\t" << count << "\t" << ms_strings << "\t" << ms_typed << "\t" << std::setprecision(2) << ms_strings / ms_typed
+              << std::setprecision(6) << "\t" << (sum_strings == sum_typed ? "yes" : "NO") << std::endl;
+}
+
+void bench_dispatch()
+{
+    std::cout << "\n-STRING AGAINST COMPILE-TIME DISPATCH, American puts\n" << std::endl;
+    std::cout << "method\t\tN\ttrees\tstrings (ms)\tTree<> (ms)\tspeedup\tidentical" << std::endl;
+    for (int N : {25, 100, 1000})
+    {
+        int count = std::max(20, 2000000 / (N * N));
+        bench_dispatch_case<BinomialAmerican, Tree<Put, American, Binomial>>("Binomial", "Binomial", N, count);
+        bench_dispatch_case<BinomialAmerican, Tree<Put, American, BBSR>>("BBSR\t", "BBSR", N, count);
+        bench_dispatch_case<TrinomialAmerican, Tree<Put, American, TBSR>>("TBSR\t", "TBSR", N, count);
+    }
+}
+
+// American trees with and without the exercise boundary tracking, prices have to agree bit for bit
+template <typename Tree>
+void bench_boundary_case(const char *name, Tree &tree, int N)
+{
+    tree.setBoundaryTracking(false);
+    double ms_full = time_ms([&]() { tree.runSimulation(); }, 1);
+    double full = tree.getPrice();
+    tree.setBoundaryTracking(true);
+    double ms_tracked = time_ms([&]() { tree.runSimulation(); }, 1);
+    const std::vector<double> &boundary = tree.getExerciseBoundary();
+    std::cout << name << "\t" << N << "\t" << ms_full << "\t" << ms_tracked << "\t" << (full == tree.getPrice() ? "yes" : "NO")
+              << "\t" << boundary[N / 2] << "\t" << boundary[N - 1] << std::endl;
+}
+
+void bench_boundary(int N_binomial, int N_trinomial)
+{
+    std::cout << "\n-EARLY EXERCISE BOUNDARY TRACKING\n" << std::endl;
+    std::cout << "tree\t\t\tN\tfull (ms)\ttracked (ms)\tidentical\tS*(T/2)\t\tS*(T-dt)" << std::endl;
+    BinomialAmerican binomial_put(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N_binomial, "Binomial", "put");
+    BinomialAmerican binomial_call(41.0, 43.0, 0.035, 0.24, 1.0, 0.05, N_binomial, "Binomial", "call");
+    TrinomialAmerican trinomial_put(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N_trinomial, "Trinomial", "put");
+    bench_boundary_case("binomial put\t", binomial_put, N_binomial);
+    bench_boundary_case("binomial call, q = 5%", binomial_call, N_binomial);
+    bench_boundary_case("trinomial put\t", trinomial_put, N_trinomial);
+}
+
+// Full against truncated European lattices: time and the price change for a few band widths
+template <typename Tree>
+void bench_truncation_case(const char *name, Tree &tree, int N)
+{
+    tree.setTruncation(0.0);
+    double ms_full = time_ms([&]() { tree.runSimulation(); }, 1);
+    double full = tree.getPrice();
+    std::cout << name << "\t" << N << "\tfull\t" << ms_full << "\t\t" << full << std::endl;
+    for (double nsd : {8.0, 6.0, 4.0, 3.0})
+    {
+        tree.setTruncation(nsd);
+        double ms = time_ms([&]() { tree.runSimulation(); }, 1);
+        std::cout << name << "\t" << N << "\t" << std::setprecision(0) << nsd << std::setprecision(6) << "\t" << ms << "\t\t" << tree.getPrice()
+                  << "\t" << std::scientific << std::abs(tree.getPrice() - full) << std::fixed << std::endl;
+    }
+}
+
+void bench_truncation(int N_binomial, int N_trinomial)
+{
+    std::cout << "\n-TRUNCATED EUROPEAN LATTICE\n" << std::endl;
+    std::cout << "tree\t\tN\tsd\ttime (ms)\tprice\t\t|error|" << std::endl;
+    BinomialEuropean binomial(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N_binomial, "Binomial", "put");
+    TrinomialEuropean trinomial(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N_trinomial, "Trinomial", "put");
+    bench_truncation_case("binomial", binomial, N_binomial);
+    bench_truncation_case("trinomial", trinomial, N_trinomial);
+}
+
+// Variance reduced American price: separate American and European trees against the fused control variate sweep
+void bench_control_variate(int N)
+{
+    std::cout << "\n-CONTROL VARIATE, N = " << N << "\n" << std::endl;
+    std::cout << "method\tAmerican (ms)\tEuropean (ms)\tfused (ms)\tidentical" << std::endl;
+    auto bs = black_scholes_values(41.0, 43.0, 1.0, 0.24, 0.035, 0.0075);
+    for (const char *method : {"BBSR", "TBSR"})
+    {
+        bool trinomial = std::string(method) == "TBSR";
+        double american = 0.0, european = 0.0, fused = 0.0;
+        double ms_american = time_ms([&]() {
+            if (trinomial)
+            {
+                TrinomialAmerican tree(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, method, "put");
+                tree.runSimulation();
+                american = tree.getPrice();
+            }
+            else
+            {
+                BinomialAmerican tree(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, method, "put");
+                tree.runSimulation();
+                american = tree.getPrice();
+            }
+        }, 1);
+        double ms_european = time_ms([&]() {
+            if (trinomial)
+            {
+                TrinomialEuropean tree(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, method, "put");
+                tree.runSimulation();
+                european = tree.getPrice();
+            }
+            else
+            {
+                BinomialEuropean tree(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, method, "put");
+                tree.runSimulation();
+                european = tree.getPrice();
+            }
+        }, 1);
+        double ms_fused = time_ms([&]() {
+            if (trinomial)
+            {
+                TrinomialControlVariate tree(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, method, "put");
+                tree.runSimulation();
+                fused = tree.getPrice();
+            }
+            else
+            {
+                BinomialControlVariate tree(41.0, 43.0, 0.035, 0.24, 1.0, 0.0075, N, method, "put");
+                tree.runSimulation();
+                fused = tree.getPrice();
+            }
+        }, 1);
+        std::cout << method << "\t" << ms_american << "\t" << ms_european << "\t" << ms_fused << "\t"
+                  << (american - european + bs["put_price"] == fused ? "yes" : "NO") << std::endl;
+    }
+}
+
+// Trinomial leaves: one pow and one map-built Black-Scholes price per node against the shared spot table,
+// then the whole Trinomial and TBS trees that start from it
+void bench_trinomial_spots(int N)
+{
+    std::cout << "\n-TRINOMIAL SPOT TABLE, N = " << N << "\n" << std::endl;
+    double S0 = 41.0, K = 43.0, r = 0.035, sigma = 0.24, T = 1.0, q = 0.0075;
+    double dt = T / N, u = exp(sigma * sqrt(3 * dt)), d = 1 / u;
+    std::vector<double> V(2 * N + 1);
+    double ms_pow = time_ms([&]() {
+        for (int i = 0; i <= 2 * N; i++)
+            V[i] = std::max(0.0, K - S0 * pow(u, N - i));
+    });
+    double ms_pow_bs = time_ms([&]() {
+        for (int i = 0; i <= 2 * N - 2; i++)
+            V[i] = black_scholes_values(S0 * pow(u, N - 1 - i), K, dt, sigma, r, q)["put_price"];
+    });
+    TrinomialSpotTable spots;
+    double ms_table = time_ms([&]() {
+        spots.build(S0, u, d, N);
+        const double *S = spots.level(N);
+        for (int i = 0; i <= 2 * N; i++)
+            V[i] = std::max(0.0, K - S[i]);
+    });
+    double ms_table_bs = time_ms([&]() {
+        spots.build(S0, u, d, N);
+        const double *S = spots.level(N - 1);
+        for (int i = 0; i <= 2 * N - 2; i++)
+            V[i] = black_scholes_price(S[i], K, dt, sigma, r, q, true);
+    });
+    std::cout << "leaves		pow (ms)	table (ms)" << std::endl;
+    std::cout << "payoff		" << ms_pow << "	" << ms_table << std::endl;
+    std::cout << "Black-Scholes	" << ms_pow_bs << "	" << ms_table_bs << std::endl;
+    std::cout << "\nmethod		American (ms)	European (ms)" << std::endl;
+    for (const char *method : {"Trinomial", "TBS"})
+    {
+        TrinomialAmerican american(S0, K, r, sigma, T, q, N, method, "put");
+        TrinomialEuropean european(S0, K, r, sigma, T, q, N, method, "put");
+        double ms_american = time_ms([&]() { american.runSimulation(); }, 1);
+        double ms_european = time_ms([&]() { european.runSimulation(); }, 1);
+        std::cout << method << "\t" << (std::string(method) == "TBS" ? "\t" : "") << ms_american << "\t" << ms_european << std::endl;
+    }
+}
+
+int main()
+{
+    std::cout << std::fixed << std::setprecision(6);
+    bench_binomial_rerun();
+    bench_simd_steps(20000);
+    bench_tiling(200000, 100000, 2048, 256);
+    bench_threads(20000);
+    bench_batch(200);
+    bench_batch(2000);
+    bench_dispatch();
+    bench_boundary(20000, 10000);
+    bench_truncation(100000, 50000);
+    bench_control_variate(20000);
+    bench_trinomial_spots(20000);
+    return 0;
+}
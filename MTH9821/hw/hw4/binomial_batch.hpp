@@ -0,0 +1,257 @@
+#ifndef BinomialBatch_hpp
+#define BinomialBatch_hpp
+
+#include "black_scholes.hpp"
+#include "lattice_kernel.hpp"
+#include <string>
+#include <vector>
+
+// Strikes are priced in blocks of 8, the values of one block stored node major: v[8 * i + k] for node i and
+// strike k, so that one node is one AVX-512 vector (two AVX2 ones) and a block's lattice stays in cache.
+// Level j of a block, nodes i = 0..j at spots[i]:
+//   v[8i + k] = max(disc_p * v[8i + k] + disc_1p * v[8(i + 1) + k], sign * (spots[i] - strikes[k]))
+// with sign = -1 for puts, +1 for calls. The continuation value is never negative, so this equals the max with
+// the payoff and each strike gets bit for bit the value of a single BinomialAmerican tree on the same instruction set.
+const int BATCH_LANES = 8;
+
+LATTICE_NO_FMA inline void batch_step_american_scalar(double *v, const double *spots, const double *strikes, int j, double sign, double disc_p, double disc_1p)
+{
+    for (int i = 0; i <= j; i++)
+    {
+        for (int k = 0; k < BATCH_LANES; k++)
+        {
+            double *x = v + BATCH_LANES * i + k;
+            *x = std::max(disc_p * x[0] + disc_1p * x[BATCH_LANES], sign * (spots[i] - strikes[k]));
+        }
+    }
+}
+
+#ifdef LATTICE_X86_SIMD
+LATTICE_NO_FMA __attribute__((target("avx2"))) inline void batch_step_american_avx2(double *v, const double *spots, const double *strikes, int j, double sign, double disc_p, double disc_1p)
+{
+    const __m256d a = _mm256_set1_pd(disc_p), b = _mm256_set1_pd(disc_1p), g = _mm256_set1_pd(sign);
+    const __m256d K0 = _mm256_load_pd(strikes), K1 = _mm256_load_pd(strikes + 4);
+    for (int i = 0; i <= j; i++)
+    {
+        double *x = v + BATCH_LANES * i;
+        __m256d S = _mm256_set1_pd(spots[i]);
+        __m256d c0 = _mm256_add_pd(_mm256_mul_pd(a, _mm256_load_pd(x)), _mm256_mul_pd(b, _mm256_load_pd(x + 8)));
+        __m256d c1 = _mm256_add_pd(_mm256_mul_pd(a, _mm256_load_pd(x + 4)), _mm256_mul_pd(b, _mm256_load_pd(x + 12)));
+        _mm256_store_pd(x, _mm256_max_pd(c0, _mm256_mul_pd(g, _mm256_sub_pd(S, K0))));
+        _mm256_store_pd(x + 4, _mm256_max_pd(c1, _mm256_mul_pd(g, _mm256_sub_pd(S, K1))));
+    }
+}
+
+LATTICE_NO_FMA __attribute__((target("avx512f"))) inline void batch_step_american_avx512(double *v, const double *spots, const double *strikes, int j, double sign, double disc_p, double disc_1p)
+{
+    const __m512d a = _mm512_set1_pd(disc_p), b = _mm512_set1_pd(disc_1p), g = _mm512_set1_pd(sign);
+    const __m512d K = _mm512_load_pd(strikes);
+    for (int i = 0; i <= j; i++)
+    {
+        double *x = v + BATCH_LANES * i;
+        __m512d c = _mm512_add_pd(_mm512_mul_pd(a, _mm512_load_pd(x)), _mm512_mul_pd(b, _mm512_load_pd(x + 8)));
+        _mm512_store_pd(x, _mm512_mask_max_pd(c, 0xFF, c, _mm512_mul_pd(g, _mm512_sub_pd(_mm512_set1_pd(spots[i]), K))));
+    }
+}
+#endif
+
+inline void batch_step_american(double *v, const double *spots, const double *strikes, int j, double sign, double disc_p, double disc_1p)
+{
+#ifdef LATTICE_X86_SIMD
+    switch (active_simd_level())
+    {
+    case SIMD_AVX512:
+        return batch_step_american_avx512(v, spots, strikes, j, sign, disc_p, disc_1p);
+    case SIMD_AVX2:
+        return batch_step_american_avx2(v, spots, strikes, j, sign, disc_p, disc_1p);
+    default:
+        break;
+    }
+#endif
+    batch_step_american_scalar(v, spots, strikes, j, sign, disc_p, disc_1p);
+}
+
+// American options on one underlying that differ only in the strike, priced on a single binomial lattice.
+// The spots, probabilities and method dispatch are shared; the backward induction carries 8 strikes at a time,
+// the block of strikes first..first + lanes - 1 keeping its nodes in V[first * (top + 1) + lanes * i + k].
+// A single tree is already vectorized across the nodes and a padded lane costs as much as a real one, so the
+// strikes left over after the blocks of 8 are priced one lattice each (lanes = 1), with the kernel and
+// exercise table of BinomialAmerican.
+class BinomialAmericanBatch
+{
+private:
+    struct Block
+    {
+        int first; // index of the first strike
+        int lanes; // BATCH_LANES or 1
+    };
+
+    double S0, r, sigma, T, q;
+    int N;
+    std::string method, type;
+    std::vector<double> strikes;
+    std::vector<Block> blocks;
+    double dt, u, d, d_bar, p, disc_p, disc_1p;
+    LatticeBuffer K_aligned;             // strikes, aligned for the block kernels
+    LatticeBuffer spots_even, spots_odd; // node spots, laid out as in BinomialExerciseTable
+    BinomialExerciseTable exercise;      // payoffs of the strike of a single lattice
+    LatticeBuffer V;
+    std::vector<double> price, delta1, gamma1, theta1;
+
+    static void fillSpots(LatticeBuffer &table, int size, double S_top, double d_bar)
+    {
+        table.resize(size);
+        double S = S_top;
+        for (int m = 0; m < size; m++)
+        {
+            table[m] = S;
+            S *= d_bar;
+        }
+    }
+
+    const double *spots(int j) const
+    {
+        return ((N - j) % 2 == 0) ? spots_even.data() + (N - j) / 2 : spots_odd.data() + (N - j - 1) / 2;
+    }
+
+    // Backward induction of every block from the leaves already stored in V at level top down to the root
+    LATTICE_NO_FMA void backwardInduction(int top)
+    {
+        FlushDenormals ftz;
+        double sign = type == "put" ? -1.0 : 1.0;
+        double level1[2 * BATCH_LANES], level2[3 * BATCH_LANES];
+        for (const Block &block : blocks)
+        {
+            const int lanes = block.lanes;
+            double *v = V.data() + (std::size_t)block.first * (top + 1);
+            const double *K = K_aligned.data() + block.first;
+            if (lanes == 1)
+                exercise.build(S0, u, d_bar, *K, N, type == "put");
+            for (int j = top - 1; j >= 0; j--)
+            {
+                if (j == 0)
+                    std::copy(v, v + 2 * lanes, level1);
+                if (j == 1)
+                    std::copy(v, v + 3 * lanes, level2);
+                if (lanes == 1)
+                    binomial_step_american(v, exercise.level(j), j, disc_p, disc_1p);
+                else
+                    batch_step_american(v, spots(j), K, j, sign, disc_p, disc_1p);
+            }
+            // calculate price, delta, gamma, theta of the block's strikes
+            for (int k = 0; k < lanes; k++)
+            {
+                int m = block.first + k;
+                double V10 = level1[k], V11 = level1[lanes + k];
+                double V20 = level2[k], V21 = level2[lanes + k], V22 = level2[2 * lanes + k];
+                price[m] = v[k];
+                delta1[m] = (V10 - V11) / (S0 * (u - d));
+                gamma1[m] = ((V20 - V21) / (S0 * u * (u - d)) - (V21 - V22) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
+                theta1[m] = (V21 - price[m]) / (2 * dt);
+            }
+        }
+    }
+
+    // leaves of every block at level j from a payoff f(S, K)
+    template <typename Payoff>
+    void fillLeaves(int j, Payoff f)
+    {
+        V.resize(strikes.size() * (j + 1));
+        const double *S = spots(j);
+        for (const Block &block : blocks)
+        {
+            double *v = V.data() + (std::size_t)block.first * (j + 1);
+            for (int i = 0; i <= j; i++)
+                for (int k = 0; k < block.lanes; k++)
+                    v[block.lanes * i + k] = f(S[i], K_aligned[block.first + k]);
+        }
+    }
+
+    // combine the results of two sub-batches as weight_a * a + weight_b * b
+    void combine(const BinomialAmericanBatch &a, const BinomialAmericanBatch &b, double weight_a, double weight_b)
+    {
+        for (std::size_t k = 0; k < strikes.size(); k++)
+        {
+            price[k] = weight_a * a.price[k] + weight_b * b.price[k];
+            delta1[k] = weight_a * a.delta1[k] + weight_b * b.delta1[k];
+            gamma1[k] = weight_a * a.gamma1[k] + weight_b * b.gamma1[k];
+            theta1[k] = weight_a * a.theta1[k] + weight_b * b.theta1[k];
+        }
+    }
+
+public:
+    LATTICE_NO_FMA BinomialAmericanBatch(double S0_, const std::vector<double> &strikes_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
+        : S0(S0_), r(r_), sigma(sigma_), T(T_), q(q_), N(N_), method(method_), type(type_), strikes(strikes_)
+    {
+        dt = T / N;
+        u = exp(sigma * sqrt(dt));
+        d = 1 / u;
+        d_bar = pow(d, 2);
+        p = (exp((r - q) * dt) - d) / (u - d);
+        disc_p = exp(-r * dt) * p;
+        disc_1p = exp(-r * dt) * (1 - p);
+
+        int count = strikes.size(), first = 0;
+        for (; first + BATCH_LANES <= count; first += BATCH_LANES)
+            blocks.push_back({first, BATCH_LANES});
+        for (; first < count; first++)
+            blocks.push_back({first, 1});
+        K_aligned.assign(strikes.begin(), strikes.end());
+        price.resize(strikes.size());
+        delta1.resize(strikes.size());
+        gamma1.resize(strikes.size());
+        theta1.resize(strikes.size());
+
+        if (method != "Binomial" && method != "AverageBinomial" && method != "BBS" && method != "BBSR")
+        {
+            std::cout << "Method not found!" << std::endl;
+        }
+    }
+
+    // results in the order of the strikes passed to the constructor
+    const std::vector<double> &getPrices() const { return price; }
+    const std::vector<double> &getDeltas() const { return delta1; }
+    const std::vector<double> &getGammas() const { return gamma1; }
+    const std::vector<double> &getThetas() const { return theta1; }
+
+    void runSimulation()
+    {
+        bool isPut = type == "put";
+        if (method == "Binomial")
+        {
+            fillSpots(spots_even, N + 1, S0 * pow(u, N), d_bar);
+            fillSpots(spots_odd, N, S0 * pow(u, N - 1), d_bar);
+            fillLeaves(N, [&](double S, double K) { return isPut ? std::max(0.0, K - S) : std::max(0.0, S - K); });
+            backwardInduction(N);
+        }
+        else if (method == "AverageBinomial")
+        {
+            BinomialAmericanBatch tree_N(S0, strikes, r, sigma, T, q, N, "Binomial", type);
+            BinomialAmericanBatch tree_Nplus1(S0, strikes, r, sigma, T, q, N + 1, "Binomial", type);
+            tree_N.runSimulation();
+            tree_Nplus1.runSimulation();
+            combine(tree_N, tree_Nplus1, 0.5, 0.5);
+        }
+        else if (method == "BBS")
+        {
+            fillSpots(spots_even, N + 1, S0 * pow(u, N), d_bar);
+            fillSpots(spots_odd, N, S0 * pow(u, N - 1), d_bar);
+            fillLeaves(N - 1, [&](double S, double K) { return black_scholes_price(S, K, dt, sigma, r, q, isPut); });
+            backwardInduction(N - 1);
+        }
+        else if (method == "BBSR")
+        {
+            BinomialAmericanBatch tree_N(S0, strikes, r, sigma, T, q, N, "BBS", type);
+            BinomialAmericanBatch tree_halfN(S0, strikes, r, sigma, T, q, N / 2, "BBS", type);
+            tree_N.runSimulation();
+            tree_halfN.runSimulation();
+            combine(tree_N, tree_halfN, 2.0, -1.0);
+        }
+        else
+        {
+            std::cout << "Method not found!" << std::endl;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef BinomialControlVariate_hpp
+#define BinomialControlVariate_hpp
+
+#include "black_scholes.hpp"
+#include "binomial_option.hpp"
+#include "lattice_kernel.hpp"
+
+// American price and Greeks corrected with the European tree as control variate,
+//   American tree - European tree + Black-Scholes,
+// from one backward sweep that carries the American and European values over the same nodes and leaves.
+// The American values take the whole lattice. The European ones take only the band of `truncation` standard
+// deviations around the spot, its edge nodes set to their Black-Scholes value as in BinomialEuropean::setTruncation.
+// At the default 10 standard deviations the band agrees with the full European tree to rounding, and the
+// control costs O(N^1.5) next to the O(N^2) American sweep. Serial: ignores tiling and threads.
+class BinomialControlVariate : public BinomialOption
+{
+private:
+    struct Values
+    {
+        double price, delta, gamma, theta;
+    };
+    LatticeBuffer A, E; // American and European node values
+    BinomialExerciseTable exercise;
+    double truncation = 10.0;
+    Values american, european, corrected;
+
+    int bandWidth() const
+    {
+        double width = (truncation * sigma * sqrt(T) + std::abs(r - q - sigma * sigma / 2) * T) / log(u);
+        return std::max(2, int(ceil(width)));
+    }
+    int bandLow(int j, int W) const { return j > W ? (j - W + 1) / 2 : 0; }
+    int bandHigh(int j, int W) const { return std::min(j, (j + W) / 2); }
+
+    double payoff(double S) const { return type == "put" ? std::max(0.0, K - S) : std::max(0.0, S - K); }
+
+    // European value of node i of level j, used for the nodes just outside the band
+    double nodeValue(int j, int i) const
+    {
+        double S = S0 * pow(u, j - 2 * i);
+        if (j == N)
+            return payoff(S);
+        return black_scholes_price(S, K, (N - j) * dt, sigma, r, q, type == "put");
+    }
+
+    Values greeks(const double *V1, const double *V2, double price) const
+    {
+        Values g;
+        g.price = price;
+        g.delta = (V1[0] - V1[1]) / (S0 * (u - d));
+        g.gamma = ((V2[0] - V2[1]) / (S0 * u * (u - d)) - (V2[1] - V2[2]) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
+        g.theta = (V2[1] - price) / (2 * dt);
+        return g;
+    }
+
+    // Both inductions from the leaves already stored in A (and copied to E) at level top down to the root
+    void backwardInduction(int top)
+    {
+        FlushDenormals ftz;
+        exercise.build(S0, u, d_bar, K, N, type == "put");
+        E.assign(A.begin(), A.end());
+        int W = truncation > 0 ? bandWidth() : top;
+        double A1[2], A2[3], E1[2], E2[3];
+        for (int j = top - 1; j >= 0; j--)
+        {
+            if (j == 0)
+            {
+                std::copy(A.data(), A.data() + 2, A1);
+                std::copy(E.data(), E.data() + 2, E1);
+            }
+            if (j == 1)
+            {
+                std::copy(A.data(), A.data() + 3, A2);
+                std::copy(E.data(), E.data() + 3, E2);
+            }
+            binomial_step_american(A.data(), exercise.level(j), j, disc_p, disc_1p);
+            int lo = j >= 2 ? bandLow(j, W) : 0, hi = j >= 2 ? bandHigh(j, W) : j;
+            for (int i = lo; i < bandLow(j + 1, W); i++)
+                E[i] = nodeValue(j + 1, i);
+            for (int i = bandHigh(j + 1, W) + 1; i <= hi + 1; i++)
+                E[i] = nodeValue(j + 1, i);
+            binomial_step(E.data() + lo, hi - lo, disc_p, disc_1p);
+        }
+        american = greeks(A1, A2, A[0]);
+        european = greeks(E1, E2, E[0]);
+    }
+
+    // weight_a * a + weight_b * b for the American and the European values
+    void combine(const BinomialControlVariate &a, const BinomialControlVariate &b, double weight_a, double weight_b)
+    {
+        auto mix = [&](const Values &x, const Values &y) {
+            return Values{weight_a * x.price + weight_b * y.price, weight_a * x.delta + weight_b * y.delta,
+                          weight_a * x.gamma + weight_b * y.gamma, weight_a * x.theta + weight_b * y.theta};
+        };
+        american = mix(a.american, b.american);
+        european = mix(a.european, b.european);
+    }
+
+    void runCombined(int N_a, int N_b, const std::string &sub, double weight_a, double weight_b)
+    {
+        BinomialControlVariate tree_a(S0, K, r, sigma, T, q, N_a, sub, type);
+        BinomialControlVariate tree_b(S0, K, r, sigma, T, q, N_b, sub, type);
+        tree_a.setTruncation(truncation);
+        tree_b.setTruncation(truncation);
+        tree_a.runSimulation();
+        tree_b.runSimulation();
+        combine(tree_a, tree_b, weight_a, weight_b);
+    }
+
+public:
+    BinomialControlVariate(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
+        : BinomialOption(S0_, K_, r_, sigma_, T_, q_, N_, method_, type_)
+    {
+        if (method != "Binomial" && method != "AverageBinomial" && method != "BBS" && method != "BBSR")
+        {
+            std::cout << "Method not found!" << std::endl;
+        }
+    }
+
+    // variance reduced price and Greeks
+    double getPrice() const { return corrected.price; }
+    double getDelta() const { return corrected.delta; }
+    double getGamma() const { return corrected.gamma; }
+    double getTheta() const { return corrected.theta; }
+
+    // the two trees on their own
+    double getAmericanPrice() const { return american.price; }
+    double getEuropeanPrice() const { return european.price; }
+
+    // Half-width of the European band in standard deviations, 0 steps the whole European lattice
+    void setTruncation(double nsd) { truncation = nsd; }
+
+    void runSimulation()
+    {
+        if (method == "Binomial")
+        {
+            A.resize(N + 1);
+            double S_temp = S0 * pow(u, N);
+            for (int i = 0; i <= N; i++)
+            {
+                A[i] = payoff(S_temp);
+                S_temp *= d_bar;
+            }
+            backwardInduction(N);
+        }
+        else if (method == "AverageBinomial")
+        {
+            runCombined(N, N + 1, "Binomial", 0.5, 0.5);
+        }
+        else if (method == "BBS")
+        {
+            A.resize(N);
+            double S_temp = S0 * pow(u, N - 1);
+            for (int i = 0; i <= N - 1; i++)
+            {
+                A[i] = black_scholes_price(S_temp, K, dt, sigma, r, q, type == "put");
+                S_temp *= d_bar;
+            }
+            backwardInduction(N - 1);
+        }
+        else if (method == "BBSR")
+        {
+            runCombined(N, N / 2, "BBS", 2.0, -1.0);
+        }
+        else
+        {
+            std::cout << "Method not found!" << std::endl;
+            return;
+        }
+        std::map<std::string, double> bs = black_scholes_values(S0, K, T, sigma, r, q);
+        corrected.price = american.price - european.price + bs[type + "_price"];
+        corrected.delta = american.delta - european.delta + bs[type + "_delta"];
+        corrected.gamma = american.gamma - european.gamma + bs["gamma"];
+        corrected.theta = american.theta - european.theta + bs[type + "_theta"];
+    }
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <vector>
 #include <cmath>
 #include <iostream>
+#include "lattice_kernel.hpp"
 
 class BinomialOption {
 protected:
@@ -13,10 +14,12 @@ protected:
     std::string type;
     std::string method;
     double dt, u, d, d_bar, p, disc_p, disc_1p;
+    int tile_width = 0, tile_levels = 0; // cache blocking of the backward induction, 0 = whole levels
+    int threads = 1;                     // threads sharing each level of the backward induction
 
 public:
     // Constructor
-    BinomialOption(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
+    LATTICE_NO_FMA BinomialOption(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
         : S0(S0_), K(K_), r(r_), sigma(sigma_), T(T_), q(q_), N(N_), method(method_), type(type_)
     {
         dt = T / N;
@@ -28,6 +31,16 @@ public:
         disc_1p = exp(-r * dt) *(1-p);
     }
 
+    // Sweep the backward induction in tiles of `width` nodes by `levels` time steps (0 turns it off)
+    void setTiling(int width, int levels)
+    {
+        tile_width = width;
+        tile_levels = levels;
+    }
+
+    // Split the levels of the backward induction across n threads, `tile_levels` (default 32) levels per barrier
+    void setThreads(int n) { threads = n; }
+
     // Virtual destructor
     virtual ~BinomialOption() {}
 
@@ -0,0 +1,640 @@
+#ifndef LatticeKernel_hpp
+#define LatticeKernel_hpp
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Allocator returning 64 byte (cache line) aligned blocks for the lattice value buffers
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+    T *allocate(std::size_t n)
+    {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T *ptr, std::size_t) noexcept
+    {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+};
+
+template <typename T, typename U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) { return true; }
+template <typename T, typename U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) { return false; }
+
+typedef std::vector<double, AlignedAllocator<double>> LatticeBuffer;
+
+// Backward steps, in place, for level j of the lattice:
+//   binomial:  V[i] = disc_p * V[i] + disc_1p * V[i + 1]                          for i = 0..j
+//   trinomial: V[i] = disc_p_u * V[i] + disc_p_m * V[i + 1] + disc_p_d * V[i + 2]   for i = 0..2j
+// The American versions take the max with exercise[i], the payoff at node i of the new level.
+// The trinomial_range kernels do the same for nodes 0..last only, for callers working on part of a level.
+// Every kernel has a scalar, an AVX2 and an AVX-512 version; the vector ones keep the scalar
+// evaluation order, and contraction of a * b + c into fused multiply-adds is off in all of them (GCC would
+// otherwise contract the avx512f kernels and -march=native builds), so all three give bit-identical results.
+// Within one instruction set the result never depends on how a level is split.
+// Reading V[i + 1], V[i + 2] before storing V[i] is safe for any vector width as i increases.
+#ifndef LATTICE_NO_FMA // also defined by black_scholes.hpp
+#if defined(__GNUC__) && !defined(__clang__)
+#define LATTICE_NO_FMA __attribute__((optimize("fp-contract=off")))
+#else
+#define LATTICE_NO_FMA
+#endif
+#endif
+
+LATTICE_NO_FMA inline void binomial_step_scalar(double *V, int j, double disc_p, double disc_1p)
+{
+    for (int i = 0; i <= j; i++)
+    {
+        V[i] = disc_p * V[i] + disc_1p * V[i + 1];
+    }
+}
+
+LATTICE_NO_FMA inline void binomial_step_american_scalar(double *V, const double *exercise, int j, double disc_p, double disc_1p)
+{
+    for (int i = 0; i <= j; i++)
+    {
+        V[i] = std::max(disc_p * V[i] + disc_1p * V[i + 1], exercise[i]);
+    }
+}
+
+LATTICE_NO_FMA inline void trinomial_range_scalar(double *V, int last, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+    for (int i = 0; i <= last; i++)
+    {
+        V[i] = disc_p_u * V[i] + disc_p_m * V[i + 1] + disc_p_d * V[i + 2];
+    }
+}
+
+LATTICE_NO_FMA inline void trinomial_range_american_scalar(double *V, const double *exercise, int last, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+    for (int i = 0; i <= last; i++)
+    {
+        V[i] = std::max(disc_p_u * V[i] + disc_p_m * V[i + 1] + disc_p_d * V[i + 2], exercise[i]);
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LATTICE_X86_SIMD
+#include <immintrin.h>
+
+// The vector kernels use plain loads/stores on full vectors and finish the last partial vector with masked
+// ones rather than a scalar loop, so a node is computed in the same lanes whatever its position in the level.
+
+__attribute__((target("avx2"))) inline __m256i avx2_tail_mask(int n)
+{
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_set_epi64x(3, 2, 1, 0));
+}
+
+LATTICE_NO_FMA __attribute__((target("avx2"))) inline __m256d binomial_avx2(__m256d x0, __m256d x1, __m256d a, __m256d b)
+{
+    return _mm256_add_pd(_mm256_mul_pd(a, x0), _mm256_mul_pd(b, x1));
+}
+
+LATTICE_NO_FMA __attribute__((target("avx2"))) inline __m256d trinomial_avx2(__m256d x0, __m256d x1, __m256d x2, __m256d a, __m256d b, __m256d c)
+{
+    return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a, x0), _mm256_mul_pd(b, x1)), _mm256_mul_pd(c, x2));
+}
+
+LATTICE_NO_FMA __attribute__((target("avx2"))) inline void binomial_step_avx2(double *V, int j, double disc_p, double disc_1p)
+{
+    const __m256d a = _mm256_set1_pd(disc_p), b = _mm256_set1_pd(disc_1p);
+    int i = 0;
+    for (; i + 4 <= j + 1; i += 4)
+    {
+        _mm256_storeu_pd(V + i, binomial_avx2(_mm256_loadu_pd(V + i), _mm256_loadu_pd(V + i + 1), a, b));
+    }
+    if (i <= j)
+    {
+        __m256i m = avx2_tail_mask(j + 1 - i);
+        _mm256_maskstore_pd(V + i, m, binomial_avx2(_mm256_maskload_pd(V + i, m), _mm256_maskload_pd(V + i + 1, m), a, b));
+    }
+}
+
+LATTICE_NO_FMA __attribute__((target("avx2"))) inline void binomial_step_american_avx2(double *V, const double *exercise, int j, double disc_p, double disc_1p)
+{
+    const __m256d a = _mm256_set1_pd(disc_p), b = _mm256_set1_pd(disc_1p);
+    int i = 0;
+    for (; i + 4 <= j + 1; i += 4)
+    {
+        __m256d cont = binomial_avx2(_mm256_loadu_pd(V + i), _mm256_loadu_pd(V + i + 1), a, b);
+        _mm256_storeu_pd(V + i, _mm256_max_pd(cont, _mm256_loadu_pd(exercise + i)));
+    }
+    if (i <= j)
+    {
+        __m256i m = avx2_tail_mask(j + 1 - i);
+        __m256d cont = binomial_avx2(_mm256_maskload_pd(V + i, m), _mm256_maskload_pd(V + i + 1, m), a, b);
+        _mm256_maskstore_pd(V + i, m, _mm256_max_pd(cont, _mm256_maskload_pd(exercise + i, m)));
+    }
+}
+
+LATTICE_NO_FMA __attribute__((target("avx2"))) inline void trinomial_range_avx2(double *V, int last, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+    const __m256d a = _mm256_set1_pd(disc_p_u), b = _mm256_set1_pd(disc_p_m), c = _mm256_set1_pd(disc_p_d);
+    int i = 0;
+    for (; i + 4 <= last + 1; i += 4)
+    {
+        _mm256_storeu_pd(V + i, trinomial_avx2(_mm256_loadu_pd(V + i), _mm256_loadu_pd(V + i + 1), _mm256_loadu_pd(V + i + 2), a, b, c));
+    }
+    if (i <= last)
+    {
+        __m256i m = avx2_tail_mask(last + 1 - i);
+        __m256d y = trinomial_avx2(_mm256_maskload_pd(V + i, m), _mm256_maskload_pd(V + i + 1, m), _mm256_maskload_pd(V + i + 2, m), a, b, c);
+        _mm256_maskstore_pd(V + i, m, y);
+    }
+}
+
+LATTICE_NO_FMA __attribute__((target("avx2"))) inline void trinomial_range_american_avx2(double *V, const double *exercise, int last, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+    const __m256d a = _mm256_set1_pd(disc_p_u), b = _mm256_set1_pd(disc_p_m), c = _mm256_set1_pd(disc_p_d);
+    int i = 0;
+    for (; i + 4 <= last + 1; i += 4)
+    {
+        __m256d y = trinomial_avx2(_mm256_loadu_pd(V + i), _mm256_loadu_pd(V + i + 1), _mm256_loadu_pd(V + i + 2), a, b, c);
+        _mm256_storeu_pd(V + i, _mm256_max_pd(y, _mm256_loadu_pd(exercise + i)));
+    }
+    if (i <= last)
+    {
+        __m256i m = avx2_tail_mask(last + 1 - i);
+        __m256d y = trinomial_avx2(_mm256_maskload_pd(V + i, m), _mm256_maskload_pd(V + i + 1, m), _mm256_maskload_pd(V + i + 2, m), a, b, c);
+        _mm256_maskstore_pd(V + i, m, _mm256_max_pd(y, _mm256_maskload_pd(exercise + i, m)));
+    }
+}
+
+__attribute__((target("avx512f"))) inline __mmask8 avx512_tail_mask(int n)
+{
+    return n >= 8 ? __mmask8(0xFF) : __mmask8((1u << n) - 1);
+}
+
+LATTICE_NO_FMA __attribute__((target("avx512f"))) inline __m512d binomial_avx512(__m512d x0, __m512d x1, __m512d a, __m512d b)
+{
+    return _mm512_add_pd(_mm512_mul_pd(a, x0), _mm512_mul_pd(b, x1));
+}
+
+LATTICE_NO_FMA __attribute__((target("avx512f"))) inline __m512d trinomial_avx512(__m512d x0, __m512d x1, __m512d x2, __m512d a, __m512d b, __m512d c)
+{
+    return _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(a, x0), _mm512_mul_pd(b, x1)), _mm512_mul_pd(c, x2));
+}
+
+// max(y, e) merged into y, with an explicit source (_mm512_max_pd merges into an undefined vector, which -Wall flags)
+__attribute__((target("avx512f"))) inline __m512d max_avx512(__m512d y, __m512d e)
+{
+    return _mm512_mask_max_pd(y, 0xFF, y, e);
+}
+
+LATTICE_NO_FMA __attribute__((target("avx512f"))) inline void binomial_step_avx512(double *V, int j, double disc_p, double disc_1p)
+{
+    const __m512d a = _mm512_set1_pd(disc_p), b = _mm512_set1_pd(disc_1p);
+    int i = 0;
+    for (; i + 8 <= j + 1; i += 8)
+    {
+        _mm512_storeu_pd(V + i, binomial_avx512(_mm512_loadu_pd(V + i), _mm512_loadu_pd(V + i + 1), a, b));
+    }
+    if (i <= j)
+    {
+        __mmask8 m = avx512_tail_mask(j + 1 - i);
+        _mm512_mask_storeu_pd(V + i, m, binomial_avx512(_mm512_maskz_loadu_pd(m, V + i), _mm512_maskz_loadu_pd(m, V + i + 1), a, b));
+    }
+}
+
+LATTICE_NO_FMA __attribute__((target("avx512f"))) inline void binomial_step_american_avx512(double *V, const double *exercise, int j, double disc_p, double disc_1p)
+{
+    const __m512d a = _mm512_set1_pd(disc_p), b = _mm512_set1_pd(disc_1p);
+    int i = 0;
+    for (; i + 8 <= j + 1; i += 8)
+    {
+        __m512d cont = binomial_avx512(_mm512_loadu_pd(V + i), _mm512_loadu_pd(V + i + 1), a, b);
+        _mm512_storeu_pd(V + i, max_avx512(cont, _mm512_loadu_pd(exercise + i)));
+    }
+    if (i <= j)
+    {
+        __mmask8 m = avx512_tail_mask(j + 1 - i);
+        __m512d cont = binomial_avx512(_mm512_maskz_loadu_pd(m, V + i), _mm512_maskz_loadu_pd(m, V + i + 1), a, b);
+        _mm512_mask_storeu_pd(V + i, m, max_avx512(cont, _mm512_maskz_loadu_pd(m, exercise + i)));
+    }
+}
+
+LATTICE_NO_FMA __attribute__((target("avx512f"))) inline void trinomial_range_avx512(double *V, int last, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+    const __m512d a = _mm512_set1_pd(disc_p_u), b = _mm512_set1_pd(disc_p_m), c = _mm512_set1_pd(disc_p_d);
+    int i = 0;
+    for (; i + 8 <= last + 1; i += 8)
+    {
+        _mm512_storeu_pd(V + i, trinomial_avx512(_mm512_loadu_pd(V + i), _mm512_loadu_pd(V + i + 1), _mm512_loadu_pd(V + i + 2), a, b, c));
+    }
+    if (i <= last)
+    {
+        __mmask8 m = avx512_tail_mask(last + 1 - i);
+        __m512d y = trinomial_avx512(_mm512_maskz_loadu_pd(m, V + i), _mm512_maskz_loadu_pd(m, V + i + 1), _mm512_maskz_loadu_pd(m, V + i + 2), a, b, c);
+        _mm512_mask_storeu_pd(V + i, m, y);
+    }
+}
+
+LATTICE_NO_FMA __attribute__((target("avx512f"))) inline void trinomial_range_american_avx512(double *V, const double *exercise, int last, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+    const __m512d a = _mm512_set1_pd(disc_p_u), b = _mm512_set1_pd(disc_p_m), c = _mm512_set1_pd(disc_p_d);
+    int i = 0;
+    for (; i + 8 <= last + 1; i += 8)
+    {
+        __m512d y = trinomial_avx512(_mm512_loadu_pd(V + i), _mm512_loadu_pd(V + i + 1), _mm512_loadu_pd(V + i + 2), a, b, c);
+        _mm512_storeu_pd(V + i, max_avx512(y, _mm512_loadu_pd(exercise + i)));
+    }
+    if (i <= last)
+    {
+        __mmask8 m = avx512_tail_mask(last + 1 - i);
+        __m512d y = trinomial_avx512(_mm512_maskz_loadu_pd(m, V + i), _mm512_maskz_loadu_pd(m, V + i + 1), _mm512_maskz_loadu_pd(m, V + i + 2), a, b, c);
+        _mm512_mask_storeu_pd(V + i, m, max_avx512(y, _mm512_maskz_loadu_pd(m, exercise + i)));
+    }
+}
+#endif
+
+// Flushes subnormal inputs and results to zero while in scope. The values of far out of the money nodes of a
+// large tree decay through the subnormal range, where each multiply costs several times a normal one.
+class FlushDenormals
+{
+#ifdef LATTICE_X86_SIMD
+private:
+    unsigned int saved_csr;
+
+public:
+    FlushDenormals() : saved_csr(_mm_getcsr()) { _mm_setcsr(saved_csr | 0x8040); } // FTZ | DAZ
+    ~FlushDenormals() { _mm_setcsr(saved_csr); }
+#endif
+};
+
+// Instruction set used by the dispatching kernels below, detected once at first use
+enum SimdLevel
+{
+    SIMD_SCALAR = 0,
+    SIMD_AVX2 = 1,
+    SIMD_AVX512 = 2
+};
+
+inline SimdLevel detect_simd_level()
+{
+#ifdef LATTICE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+#endif
+    return SIMD_SCALAR;
+}
+
+inline SimdLevel &active_simd_level()
+{
+    static SimdLevel level = detect_simd_level();
+    return level;
+}
+
+// Force a lower instruction set (e.g. to benchmark against the scalar loops); requests above what the CPU supports are capped
+inline void set_simd_level(SimdLevel level)
+{
+    active_simd_level() = std::min(level, detect_simd_level());
+}
+
+inline void binomial_step(double *V, int j, double disc_p, double disc_1p)
+{
+#ifdef LATTICE_X86_SIMD
+    switch (active_simd_level())
+    {
+    case SIMD_AVX512:
+        return binomial_step_avx512(V, j, disc_p, disc_1p);
+    case SIMD_AVX2:
+        return binomial_step_avx2(V, j, disc_p, disc_1p);
+    default:
+        break;
+    }
+#endif
+    binomial_step_scalar(V, j, disc_p, disc_1p);
+}
+
+inline void binomial_step_american(double *V, const double *exercise, int j, double disc_p, double disc_1p)
+{
+#ifdef LATTICE_X86_SIMD
+    switch (active_simd_level())
+    {
+    case SIMD_AVX512:
+        return binomial_step_american_avx512(V, exercise, j, disc_p, disc_1p);
+    case SIMD_AVX2:
+        return binomial_step_american_avx2(V, exercise, j, disc_p, disc_1p);
+    default:
+        break;
+    }
+#endif
+    binomial_step_american_scalar(V, exercise, j, disc_p, disc_1p);
+}
+
+inline void trinomial_range(double *V, int last, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+#ifdef LATTICE_X86_SIMD
+    switch (active_simd_level())
+    {
+    case SIMD_AVX512:
+        return trinomial_range_avx512(V, last, disc_p_u, disc_p_m, disc_p_d);
+    case SIMD_AVX2:
+        return trinomial_range_avx2(V, last, disc_p_u, disc_p_m, disc_p_d);
+    default:
+        break;
+    }
+#endif
+    trinomial_range_scalar(V, last, disc_p_u, disc_p_m, disc_p_d);
+}
+
+inline void trinomial_step(double *V, int j, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+    trinomial_range(V, 2 * j, disc_p_u, disc_p_m, disc_p_d);
+}
+
+inline void trinomial_range_american(double *V, const double *exercise, int last, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+#ifdef LATTICE_X86_SIMD
+    switch (active_simd_level())
+    {
+    case SIMD_AVX512:
+        return trinomial_range_american_avx512(V, exercise, last, disc_p_u, disc_p_m, disc_p_d);
+    case SIMD_AVX2:
+        return trinomial_range_american_avx2(V, exercise, last, disc_p_u, disc_p_m, disc_p_d);
+    default:
+        break;
+    }
+#endif
+    trinomial_range_american_scalar(V, exercise, last, disc_p_u, disc_p_m, disc_p_d);
+}
+
+inline void trinomial_step_american(double *V, const double *exercise, int j, double disc_p_u, double disc_p_m, double disc_p_d)
+{
+    trinomial_range_american(V, exercise, 2 * j, disc_p_u, disc_p_m, disc_p_d);
+}
+
+// Payoffs on every node of a binomial tree with N steps.
+// Node i of level j sits at S0 * u^(j - 2i). Levels with N - j even share the spots S0 * u^N * d_bar^m,
+// the others share S0 * u^(N - 1) * d_bar^m, with m = (N - j) / 2 + i, so each level is a contiguous slice
+// of one of two tables of size N + 1 and N.
+class BinomialExerciseTable
+{
+private:
+    int N = 0;
+    LatticeBuffer even, odd;
+
+    static void fill(LatticeBuffer &table, int size, double S_top, double d_bar, double K, bool isPut)
+    {
+        table.resize(size);
+        double S = S_top;
+        for (int m = 0; m < size; m++)
+        {
+            table[m] = isPut ? std::max(0.0, K - S) : std::max(0.0, S - K);
+            S *= d_bar;
+        }
+    }
+
+public:
+    void build(double S0, double u, double d_bar, double K, int N_, bool isPut)
+    {
+        N = N_;
+        fill(even, N + 1, S0 * pow(u, N), d_bar, K, isPut);
+        fill(odd, N, S0 * pow(u, N - 1), d_bar, K, isPut);
+    }
+
+    // payoffs of level j, indexed by node i = 0..j
+    const double *level(int j) const
+    {
+        return ((N - j) % 2 == 0) ? even.data() + (N - j) / 2 : odd.data() + (N - j - 1) / 2;
+    }
+};
+
+// Spots of every node of a trinomial tree with N steps, filled once per tree.
+// Node i of level j sits at S0 * u^(j - i); all levels share the 2N + 1 spots S0 * u^(N - m),
+// and level j reads the slice starting at m = N - j.
+class TrinomialSpotTable
+{
+private:
+    int N = 0;
+    LatticeBuffer table;
+
+public:
+    void build(double S0, double u, double d, int N_)
+    {
+        N = N_;
+        table.resize(2 * N + 1);
+        double S = S0 * pow(u, N);
+        for (int m = 0; m <= 2 * N; m++)
+        {
+            table[m] = S;
+            S *= d;
+        }
+    }
+
+    // spots of level j, indexed by node i = 0..2j
+    const double *level(int j) const { return table.data() + N - j; }
+};
+
+// Payoffs on every node of a trinomial tree, laid out as the spot table they are taken from
+class TrinomialExerciseTable
+{
+private:
+    int N = 0;
+    LatticeBuffer table;
+
+public:
+    void build(const TrinomialSpotTable &spots, double K, int N_, bool isPut)
+    {
+        N = N_;
+        table.resize(2 * N + 1);
+        const double *S = spots.level(N);
+        for (int m = 0; m <= 2 * N; m++)
+        {
+            table[m] = isPut ? std::max(0.0, K - S[m]) : std::max(0.0, S[m] - K);
+        }
+    }
+
+    // payoffs of level j, indexed by node i = 0..2j
+    const double *level(int j) const { return table.data() + N - j; }
+};
+
+// Early exercise boundary of an American tree, tracked level by level so that each level splits into
+//   continuation:  out of the money nodes, stepped without the exercise check (their payoff is 0)
+//   free boundary: stepped with max(continuation, exercise)
+//   deep exercise: every child already exercised and K(1 - disc) - S(1 - g) >= m(K + S), set to the payoff
+// where disc = exp(-r dt) and g = sum over the children of disc_p_x * S_child / S, so that the continuation of
+// exercised children is K disc - S g; the margin m covers the rounding of the stored payoffs and spots. Node
+// ranges are chosen a node inside the analytic bounds, so the values are bit-identical to the full max.
+// For a put the three ranges run left to right (spots fall with the node index), for a call right to left.
+// Nodes are indexed as in the exercise tables: node i of level j at S0 * u^(j - stride * i), stride = 2 binomial, 1 trinomial.
+class ExerciseBoundary
+{
+private:
+    bool isPut = true;
+    int stride = 2, children = 2;
+    double S0 = 0.0, u = 1.0;
+    double e_money = 0.0; // S0 * u^e_money = K
+    double e_deep = 0.0;  // deep exercise below this exponent for a put, above it for a call
+    int edge = 0;         // put: first exercised node of the level above, call: one past its last
+    std::vector<double> boundary;
+
+    static int clampIndex(double x, int hi) { return x <= 0 ? 0 : x >= hi ? hi : int(x); }
+
+    void record(int j)
+    {
+        int last = (children - 1) * j;
+        if (isPut)
+            boundary[j] = edge <= last ? S0 * pow(u, j - stride * edge) : 0.0;
+        else
+            boundary[j] = edge > 0 ? S0 * pow(u, j - stride * (edge - 1)) : 0.0;
+    }
+
+public:
+    // disc and g as above; V and exercise hold the leaves and their payoffs at level top
+    void start(double S0_, double K, double u_, double disc, double g, bool isPut_, bool trinomial,
+               const double *V, const double *exercise, int top)
+    {
+        const double m = 1e-9;
+        S0 = S0_;
+        u = u_;
+        isPut = isPut_;
+        stride = trinomial ? 1 : 2;
+        children = trinomial ? 3 : 2;
+        double log_u = log(u);
+        e_money = log(K / S0) / log_u;
+        // put: S (1 - g + m) <= K (1 - disc - m), call: S (1 - g - m) >= K (1 - disc + m)
+        double A = isPut ? 1 - g + m : 1 - g - m, B = isPut ? K * (1 - disc - m) : K * (1 + m - disc);
+        if (A > 0 && B > 0)
+            e_deep = log(B / A / S0) / log_u;
+        else if (isPut)
+            e_deep = (A <= 0 && B >= 0) ? HUGE_VAL : -HUGE_VAL;
+        else
+            e_deep = A > 0 ? -HUGE_VAL : HUGE_VAL;
+        boundary.assign(top + 1, 0.0);
+
+        int last = (children - 1) * top;
+        if (isPut)
+        {
+            for (edge = last + 1; edge > 0 && V[edge - 1] == exercise[edge - 1] && exercise[edge - 1] > 0; edge--)
+                ;
+        }
+        else
+        {
+            for (edge = 0; edge <= last && V[edge] == exercise[edge] && exercise[edge] > 0; edge++)
+                ;
+        }
+        record(top);
+    }
+
+    // Level j from level j + 1: european(v, last) and american(v, exercise, last) step nodes 0..last of v
+    template <typename European, typename American>
+    void step(double *V, const double *exercise, int j, European european, American american)
+    {
+        int last = (children - 1) * j;
+        if (isPut)
+        {
+            int itm = clampIndex(floor((j - e_money) / stride), last + 1);
+            int deep = clampIndex(ceil((j - e_deep) / stride) + 1, last + 1);
+            int hi = std::max(std::max(edge, deep), itm);
+            hi = std::min(hi, last + 1);
+            if (itm > 0)
+                european(V, itm - 1);
+            if (hi > itm)
+                american(V + itm, exercise + itm, hi - itm - 1);
+            std::copy(exercise + hi, exercise + last + 1, V + hi);
+            for (edge = hi; edge > itm && V[edge - 1] == exercise[edge - 1] && exercise[edge - 1] > 0; edge--)
+                ;
+        }
+        else
+        {
+            int otm = clampIndex(ceil((j - e_money) / stride) + 1, last + 1);
+            int deep = clampIndex(floor((j - e_deep) / stride), last + 1);
+            int lo = std::max(0, std::min(std::min(edge - children + 1, deep), otm));
+            std::copy(exercise, exercise + lo, V);
+            if (otm > lo)
+                american(V + lo, exercise + lo, otm - lo - 1);
+            if (otm <= last)
+                european(V + otm, last - otm);
+            for (edge = lo; edge < otm && V[edge] == exercise[edge] && exercise[edge] > 0; edge++)
+                ;
+        }
+        record(j);
+    }
+
+    // Spot of the exercise boundary at every level (time j * dt): the highest exercised spot for a put,
+    // the lowest for a call, 0 where no node of the level is exercised
+    const std::vector<double> &spots() const { return boundary; }
+};
+
+// Cache blocked backward induction from level top down to level bottom.
+// The levels are swept `levels` at a time; inside such a band the nodes are cut into tiles `width` wide
+// that lean back by `span` nodes per level (span = 1 binomial, 2 trinomial), so that each tile only reads
+// values its left neighbour has finished and its right neighbour has not touched yet. The tiles run left
+// to right, in place, and step(j, V + lo, lo, hi) updates nodes lo..hi of level j with the usual one-level
+// kernel, so the result is bit-identical to stepping whole levels.
+template <typename Step>
+void tiled_induction(double *V, int top, int bottom, int span, int width, int levels, Step step)
+{
+    for (int h = top; h > bottom; h -= levels)
+    {
+        int steps = std::min(levels, h - bottom);
+        for (int b = 0; b * width <= span * (h - 1); b++)
+        {
+            for (int s = 1; s <= steps; s++)
+            {
+                int lo = std::max(0, b * width - span * (s - 1));
+                int hi = std::min(span * (h - s), (b + 1) * width - span * (s - 1) - 1);
+                if (lo <= hi)
+                {
+                    step(h - s, V + lo, lo, hi);
+                }
+            }
+        }
+    }
+}
+
+// One-level updates of nodes lo..hi stored at v[0..hi - lo], exercise == nullptr prices the European tree
+inline auto binomial_range_step(double disc_p, double disc_1p, const BinomialExerciseTable *exercise)
+{
+    return [=](int j, double *v, int lo, int hi) {
+        if (exercise)
+            binomial_step_american(v, exercise->level(j) + lo, hi - lo, disc_p, disc_1p);
+        else
+            binomial_step(v, hi - lo, disc_p, disc_1p);
+    };
+}
+
+inline auto trinomial_range_step(double disc_p_u, double disc_p_m, double disc_p_d, const TrinomialExerciseTable *exercise)
+{
+    return [=](int j, double *v, int lo, int hi) {
+        if (exercise)
+            trinomial_range_american(v, exercise->level(j) + lo, hi - lo, disc_p_u, disc_p_m, disc_p_d);
+        else
+            trinomial_range(v, hi - lo, disc_p_u, disc_p_m, disc_p_d);
+    };
+}
+
+inline void binomial_induction_tiled(double *V, int top, int bottom, double disc_p, double disc_1p,
+                                     const BinomialExerciseTable *exercise, int width, int levels)
+{
+    tiled_induction(V, top, bottom, 1, width, levels, binomial_range_step(disc_p, disc_1p, exercise));
+}
+
+inline void trinomial_induction_tiled(double *V, int top, int bottom, double disc_p_u, double disc_p_m, double disc_p_d,
+                                      const TrinomialExerciseTable *exercise, int width, int levels)
+{
+    tiled_induction(V, top, bottom, 2, width, levels, trinomial_range_step(disc_p_u, disc_p_m, disc_p_d, exercise));
+}
+
+#endif
@@ -0,0 +1,242 @@
+#ifndef LatticeTree_hpp
+#define LatticeTree_hpp
+
+#include "black_scholes.hpp"
+#include "lattice_kernel.hpp"
+#include <type_traits>
+
+// Option type, exercise style and method fixed at compile time: Tree<Put, American, BBSR> selects the payoff,
+// the exercise rule and the lattice through its template arguments, so there is no string compare or virtual
+// call between the constructor and the kernels. Prices and Greeks are the same, bit for bit, as those of the
+// string dispatched BinomialEuropean / BinomialAmerican / TrinomialEuropean / TrinomialAmerican.
+
+struct Call
+{
+    static const bool isPut = false;
+    static double payoff(double S, double K) { return std::max(0.0, S - K); }
+};
+
+struct Put
+{
+    static const bool isPut = true;
+    static double payoff(double S, double K) { return std::max(0.0, K - S); }
+};
+
+struct European
+{
+    static const bool early = false;
+};
+
+struct American
+{
+    static const bool early = true;
+};
+
+// Methods: the lattice, the leaves (payoff, or Black-Scholes one step before expiry), and for the combined
+// methods the sub-tree they are built from with  price = weight * tree(N) + (1 - weight) * tree(other_N)
+enum TreeCombine
+{
+    COMBINE_NONE,
+    COMBINE_AVERAGE,   // tree(N) and tree(N + 1), weight 1/2
+    COMBINE_RICHARDSON // tree(N) and tree(N / 2), weight 2
+};
+
+struct Binomial
+{
+    static const bool trinomial = false, bsLeaves = false;
+    static const TreeCombine combine = COMBINE_NONE;
+    typedef Binomial Sub;
+};
+
+struct BBS
+{
+    static const bool trinomial = false, bsLeaves = true;
+    static const TreeCombine combine = COMBINE_NONE;
+    typedef BBS Sub;
+};
+
+struct AverageBinomial
+{
+    static const bool trinomial = false, bsLeaves = false;
+    static const TreeCombine combine = COMBINE_AVERAGE;
+    typedef Binomial Sub;
+};
+
+struct BBSR
+{
+    static const bool trinomial = false, bsLeaves = true;
+    static const TreeCombine combine = COMBINE_RICHARDSON;
+    typedef BBS Sub;
+};
+
+struct Trinomial
+{
+    static const bool trinomial = true, bsLeaves = false;
+    static const TreeCombine combine = COMBINE_NONE;
+    typedef Trinomial Sub;
+};
+
+struct TBS
+{
+    static const bool trinomial = true, bsLeaves = true;
+    static const TreeCombine combine = COMBINE_NONE;
+    typedef TBS Sub;
+};
+
+struct TBSR
+{
+    static const bool trinomial = true, bsLeaves = true;
+    static const TreeCombine combine = COMBINE_RICHARDSON;
+    typedef TBS Sub;
+};
+
+template <class Type, class Style, class Method>
+class Tree
+{
+private:
+    double S0, K, r, sigma, T, q;
+    int N;
+    double dt, u, d, d_bar;
+    double disc_u, disc_m, disc_d; // binomial trees use disc_u = disc_p and disc_d = disc_1p
+    LatticeBuffer V;
+    typename std::conditional<Method::trinomial, TrinomialExerciseTable, BinomialExerciseTable>::type exercise;
+    TrinomialSpotTable spots; // trinomial trees only
+    double price, delta1, gamma1, theta1;
+
+    // one level of the induction, the payoff and exercise rule resolved at compile time
+    void step(int j)
+    {
+        if constexpr (Method::trinomial && Style::early)
+            trinomial_step_american(V.data(), exercise.level(j), j, disc_u, disc_m, disc_d);
+        else if constexpr (Method::trinomial)
+            trinomial_step(V.data(), j, disc_u, disc_m, disc_d);
+        else if constexpr (Style::early)
+            binomial_step_american(V.data(), exercise.level(j), j, disc_u, disc_d);
+        else
+            binomial_step(V.data(), j, disc_u, disc_d);
+    }
+
+    // Backward induction from the leaves already stored in V at level top down to the root
+    LATTICE_NO_FMA void backwardInduction(int top)
+    {
+        FlushDenormals ftz;
+        if constexpr (Style::early)
+        {
+            if constexpr (Method::trinomial)
+                exercise.build(spots, K, N, Type::isPut);
+            else
+                exercise.build(S0, u, d_bar, K, N, Type::isPut);
+        }
+        // level 1 and level 2 nodes used by the Greeks: binomial V1[0..1], V2[0..2]; trinomial V1[0..2], V2[0, 2, 4]
+        double V1[3] = {0.0, 0.0, 0.0}, V2[3] = {0.0, 0.0, 0.0};
+        const int span = Method::trinomial ? 2 : 1;
+        for (int j = top - 1; j >= 0; j--)
+        {
+            if (j == 0)
+            {
+                for (int i = 0; i <= span; i++)
+                    V1[i] = V[i];
+            }
+            if (j == 1)
+            {
+                for (int i = 0; i <= 2; i++)
+                    V2[i] = V[span * i];
+            }
+            step(j);
+        }
+        // calculate price, delta, gamma, theta
+        price = V[0];
+        delta1 = (V1[0] - V1[span]) / (S0 * (u - d));
+        gamma1 = ((V2[0] - V2[1]) / (S0 * u * (u - d)) - (V2[1] - V2[2]) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
+        if constexpr (Method::trinomial)
+            theta1 = (V1[1] - price) / dt;
+        else
+            theta1 = (V2[1] - price) / (2 * dt);
+    }
+
+public:
+    LATTICE_NO_FMA Tree(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_)
+        : S0(S0_), K(K_), r(r_), sigma(sigma_), T(T_), q(q_), N(N_)
+    {
+        dt = T / N;
+        if constexpr (Method::trinomial)
+        {
+            u = exp(sigma * sqrt(3 * dt));
+            d = 1 / u;
+            double p_u = 1.0 / 6.0 + (r - q - pow(sigma, 2) / 2) * sqrt(dt / (12 * pow(sigma, 2)));
+            double p_d = 1.0 / 6.0 - (r - q - pow(sigma, 2) / 2) * sqrt(dt / (12 * pow(sigma, 2)));
+            double p_m = 2.0 / 3.0;
+            disc_u = exp(-r * dt) * p_u;
+            disc_m = exp(-r * dt) * p_m;
+            disc_d = exp(-r * dt) * p_d;
+        }
+        else
+        {
+            u = exp(sigma * sqrt(dt));
+            d = 1 / u;
+            double p = (exp((r - q) * dt) - d) / (u - d);
+            disc_u = exp(-r * dt) * p;
+            disc_m = 0.0;
+            disc_d = exp(-r * dt) * (1 - p);
+        }
+        d_bar = pow(d, 2);
+    }
+
+    double getPrice() const { return price; }
+    double getDelta() const { return delta1; }
+    double getGamma() const { return gamma1; }
+    double getTheta() const { return theta1; }
+
+    void runSimulation()
+    {
+        if constexpr (Method::combine != COMBINE_NONE)
+        {
+            const bool average = Method::combine == COMBINE_AVERAGE;
+            Tree<Type, Style, typename Method::Sub> tree_N(S0, K, r, sigma, T, q, N);
+            Tree<Type, Style, typename Method::Sub> tree_other(S0, K, r, sigma, T, q, average ? N + 1 : N / 2);
+            tree_N.runSimulation();
+            tree_other.runSimulation();
+            if (average)
+            {
+                price = (tree_N.getPrice() + tree_other.getPrice()) / 2;
+                delta1 = (tree_N.getDelta() + tree_other.getDelta()) / 2;
+                gamma1 = (tree_N.getGamma() + tree_other.getGamma()) / 2;
+                theta1 = (tree_N.getTheta() + tree_other.getTheta()) / 2;
+            }
+            else
+            {
+                price = 2 * tree_N.getPrice() - tree_other.getPrice();
+                delta1 = 2 * tree_N.getDelta() - tree_other.getDelta();
+                gamma1 = 2 * tree_N.getGamma() - tree_other.getGamma();
+                theta1 = 2 * tree_N.getTheta() - tree_other.getTheta();
+            }
+        }
+        else if constexpr (Method::trinomial)
+        {
+            // leaves at level N (payoff) or N - 1 (Black-Scholes over the last step)
+            int top = Method::bsLeaves ? N - 1 : N;
+            V.resize(2 * top + 1);
+            spots.build(S0, u, d, N);
+            const double *S = spots.level(top);
+            for (int i = 0; i <= 2 * top; i++)
+            {
+                V[i] = Method::bsLeaves ? black_scholes_price(S[i], K, dt, sigma, r, q, Type::isPut) : Type::payoff(S[i], K);
+            }
+            backwardInduction(top);
+        }
+        else
+        {
+            int top = Method::bsLeaves ? N - 1 : N;
+            V.resize(top + 1);
+            double S = S0 * pow(u, top);
+            for (int i = 0; i <= top; i++)
+            {
+                V[i] = Method::bsLeaves ? black_scholes_price(S, K, dt, sigma, r, q, Type::isPut) : Type::payoff(S, K);
+                S *= d_bar;
+            }
+            backwardInduction(top);
+        }
+    }
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include "binomial_european.hpp"
 #include "binomial_american.hpp"
 #include "binomial_option.hpp"
+#include "binomial_control_variate.hpp"
+#include "trinomial_control_variate.hpp"
 //#include "trinomial_implied_volatility.hpp"
 #include <iostream>
 
@@ -44,27 +46,25 @@ void runTrinomialCalculator(TrinomialOption &trinop, double V_actual, double D_a
     std::cout << delta << "\t" << std::abs(delta - D_actual) << "\t" << gamma << "\t" << std::abs(gamma - G_actual) << "\t" << theta << "\t" << std::abs(theta - T_actual) << std::endl;
 }
 
-// FOR VARIANCE REDUCTION ONLY
-void runBinomialCalculator_VR(BinomialOption &binop, BinomialOption &binop2, double V_actual, double D_actual, double G_actual, double T_actual, double V_BS, double D_BS, double G_BS, double T_BS, int N)
+// FOR VARIANCE REDUCTION ONLY: American tree - European tree + Black-Scholes, both trees in one sweep
+void runBinomialCalculator_VR(BinomialControlVariate &binop, double V_actual, double D_actual, double G_actual, double T_actual, int N)
 {
     binop.runSimulation();
-    binop2.runSimulation();
-    double price = binop.getPrice() - binop2.getPrice() + V_BS;
-    double delta = binop.getDelta() - binop2.getDelta() + D_BS;
-    double gamma = binop.getGamma() - binop2.getGamma() + G_BS;
-    double theta = binop.getTheta() - binop2.getTheta() + T_BS;
+    double price = binop.getPrice();
+    double delta = binop.getDelta();
+    double gamma = binop.getGamma();
+    double theta = binop.getTheta();
     std::cout << N << "\t" << price << "\t" << std::abs(price - V_actual) << "\t" << N * std::abs(price - V_actual) << "\t" << N * N * std::abs(price - V_actual) << "\t";
     std::cout << delta << "\t" << std::abs(delta - D_actual) << "\t" << gamma << "\t" << std::abs(gamma - G_actual) << "\t" << theta << "\t" << std::abs(theta - T_actual) << std::endl;
 }
 
-void runTrinomialCalculator_VR(TrinomialAmerican &triam, TrinomialEuropean &trieu, double V_actual, double D_actual, double G_actual, double T_actual, double V_BS, double D_BS, double G_BS, double T_BS, int N)
+void runTrinomialCalculator_VR(TrinomialControlVariate &trinop, double V_actual, double D_actual, double G_actual, double T_actual, int N)
 {
-    triam.runSimulation();
-    trieu.runSimulation();
-    double price = triam.getPrice() - trieu.getPrice() + V_BS;
-    double delta = triam.getDelta() - trieu.getDelta() + D_BS;
-    double gamma = triam.getGamma() - trieu.getGamma() + G_BS;
-    double theta = triam.getTheta() - trieu.getTheta() + T_BS;
+    trinop.runSimulation();
+    double price = trinop.getPrice();
+    double delta = trinop.getDelta();
+    double gamma = trinop.getGamma();
+    double theta = trinop.getTheta();
     std::cout << N << "\t" << price << "\t" << std::abs(price - V_actual) << "\t" << N * std::abs(price - V_actual) << "\t" << N * N * std::abs(price - V_actual) << "\t";
     std::cout << delta << "\t" << std::abs(delta - D_actual) << "\t" << gamma << "\t" << std::abs(gamma - G_actual) << "\t" << theta << "\t" << std::abs(theta - T_actual) << std::endl;
 }
@@ -109,6 +109,7 @@ int main()
     // AMERICAN OPTIONS
     std::cout << "\n-AMERICAN OPTION\n" << std::endl;
     BinomialAmerican binomial_american(S0, K, r, sigma, T, q, 10000, "AverageBinomial", type);
+    binomial_american.setThreads(std::max(1u, std::thread::hardware_concurrency())); // reference price, identical on any thread count
     binomial_american.runSimulation();
     double V_Exact = binomial_american.getPrice();
     double D_Exact = binomial_american.getDelta();
@@ -143,9 +144,8 @@ int main()
         std::cout << "N\tprice\t\tabs error\tN * abs error\tN^2 * abs error\tdelta\t\tD abs error\tgamma\t\tG abs error\ttheta\t\tT abs error\t" << std::endl;
         for (int N : Ns2)
         {
-            TrinomialAmerican trinomial_american(S0, K, r, sigma, T, q, N, method, type);
-            TrinomialEuropean trinomial_european(S0, K, r, sigma, T, q, N, method, type);
-            runTrinomialCalculator_VR(trinomial_american, trinomial_european, V_Exact, D_Exact, G_Exact, T_Exact, V_BS, D_BS, G_BS, T_BS, N);
+            TrinomialControlVariate trinomial_cv(S0, K, r, sigma, T, q, N, method, type);
+            runTrinomialCalculator_VR(trinomial_cv, V_Exact, D_Exact, G_Exact, T_Exact, N);
         }
     }
 
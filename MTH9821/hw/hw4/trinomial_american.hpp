@@ -3,6 +3,7 @@
 
 #include "black_scholes.hpp"
 #include "trinomial_option.hpp"
+#include "lattice_parallel.hpp"
 
 #ifndef Option_value
 #define Option_value
@@ -28,29 +29,69 @@ class TrinomialAmerican : public TrinomialOption
 {
 private:
     std::vector<std::string> methods{"Trinomial", "TBS", "TBSR"}; 
-    double S_temp;
-    std::vector<double> V;
+    LatticeBuffer V; // reused across runs, sized to the leaf level on every call
+    TrinomialSpotTable spots;
+    TrinomialExerciseTable exercise;
+    bool track_boundary = false;
+    ExerciseBoundary boundary;
     double V10, V11, V20, V22, V12, V24;
     double price, delta1, gamma1, theta1;
 
-public:
-    TrinomialAmerican(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
-        : TrinomialOption(S0_, K_, r_, sigma_, T_, q_, N_, method_, type_)
+    // Backward induction from the leaves already stored in V at level top down to the root
+    LATTICE_NO_FMA void backwardInduction(int top)
     {
-        if (method == "Trinomial")
+        FlushDenormals ftz;
+        exercise.build(spots, K, N, type == "put");
+        int j = top - 1;
+        if (track_boundary)
         {
-            S_temp = S0 * pow(u, N);
+            boundary.start(S0, K, u, exp(-r * dt), disc_p_u * u + disc_p_m + disc_p_d * d, type == "put", true, V.data(), exercise.level(top), top);
         }
-        
-        else if (method == "TBS")
+        // parallel or blocked sweep down to level 2, the last two levels are stepped below to record the Greeks;
+        // boundary tracking goes level by level, skipping the continuation and deep exercise nodes
+        auto european = [&](double *v, int last) { trinomial_range(v, last, disc_p_u, disc_p_m, disc_p_d); };
+        auto american = [&](double *v, const double *ex, int last) { trinomial_range_american(v, ex, last, disc_p_u, disc_p_m, disc_p_d); };
+        if (!track_boundary && threads > 1 && top > 2)
         {
-            S_temp = S0 * pow(u, N - 1);
+            trinomial_induction_parallel(V.data(), top, 2, disc_p_u, disc_p_m, disc_p_d, &exercise, threads, tile_levels > 0 ? tile_levels : 32);
+            j = 1;
         }
-        else if (method == "TBSR")
+        else if (!track_boundary && tile_width > 0 && tile_levels > 0 && top > 2)
         {
-            // do nothing
+            trinomial_induction_tiled(V.data(), top, 2, disc_p_u, disc_p_m, disc_p_d, &exercise, tile_width, tile_levels);
+            j = 1;
         }
-        else
+        for (; j >= 0; j--)
+        {
+            if (j == 0)
+            {
+                V10 = V[0];
+                V11 = V[1];
+                V12 = V[2];
+            }
+            if (j == 1)
+            {
+                V20 = V[0];
+                V22 = V[2];
+                V24 = V[4];
+            }
+            if (track_boundary)
+                boundary.step(V.data(), exercise.level(j), j, european, american);
+            else
+                trinomial_step_american(V.data(), exercise.level(j), j, disc_p_u, disc_p_m, disc_p_d);
+        }
+        // calculate price, delta, gamma, theta
+        price = V[0];
+        delta1 = (V10 - V12) / (S0 * (u - d));
+        gamma1 = ((V20 - V22) / (S0 * u * (u - d)) - (V22 - V24) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
+        theta1 = (V11 - price) / dt;
+    }
+
+public:
+    TrinomialAmerican(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
+        : TrinomialOption(S0_, K_, r_, sigma_, T_, q_, N_, method_, type_)
+    {
+        if (method != "Trinomial" && method != "TBS" && method != "TBSR")
         {
             std::cout << "Method not found!" << std::endl;
         }
@@ -62,76 +103,51 @@ public:
     double getGamma() const { return gamma1; }
     double getTheta() const { return theta1; }
 
+    // Track the early exercise boundary during the induction (serial, ignores tiling and threads). Nodes out of
+    // the money skip the exercise check and nodes deep in the exercise region take the payoff directly.
+    void setBoundaryTracking(bool on) { track_boundary = on; }
+
+    // Boundary spot at each level j = 0..N - 1 (time j * dt) of the last run with tracking on, see ExerciseBoundary;
+    // TBSR reports the boundary of its N step tree
+    const std::vector<double> &getExerciseBoundary() const { return boundary.spots(); }
+
     void runSimulation()
     {
         if (method == "Trinomial")
         {
+            V.resize(2 * N + 1);
+            spots.build(S0, u, d, N);
+            const double *S = spots.level(N);
             for (int i = 0; i <= 2 * N; i++)
             {
-                V.push_back(option_value(K, S0 * pow(u, N - i), type));
-            }
-            for (int j = N - 1; j >= 0; j--)
-            {
-                if (j == 0)
-                {
-                    V10 = V[0];
-                    V11 = V[1];
-                    V12 = V[2];
-                }
-                if (j == 1)
-                {
-                    V20 = V[0];
-                    V22 = V[2];
-                    V24 = V[4];
-                }
-                for (int i = 0; i <= 2 * j; i++)
-                {
-                    V[i] = std::max(disc_p_u * V[i] + disc_p_m * V[i + 1] + disc_p_d * V[i + 2],std::max(0.0, K - S0 * pow(u, j - i))); 
-                }
+                V[i] = option_value(K, S[i], type);
             }
-            // calculate price, delta, gamma, theta
-            price = V[0];
-            delta1 = (V10 - V12) / (S0 * (u - d));
-            gamma1 = ((V20 - V22) / (S0 * u * (u - d)) - (V22 - V24) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
-            theta1 = (V11 - price) / dt;
+            backwardInduction(N);
         }
         
         else if (method == "TBS")
         {
-            for (int i = 0; i <= 2*N - 2; i++)
-            {
-                V.push_back(black_scholes_values(S0 * pow(u, N - i), K, dt, sigma, r, q)[type + "_price"]);
-            }
-            for (int j = N - 2; j >= 0; j--)
+            V.resize(2 * N - 1);
+            spots.build(S0, u, d, N);
+            const double *S = spots.level(N - 1);
+            for (int i = 0; i <= 2 * N - 2; i++)
             {
-                if (j == 0)
-                {
-                    V10 = V[0];
-                    V11 = V[1];
-                    V12 = V[2];
-                }
-                if (j == 1)
-                {
-                    V20 = V[0];
-                    V22 = V[2];
-                    V24 = V[4];
-                }
-                for (int i = 0; i <= 2 * j; i++)
-                {
-                    V[i] = std::max(disc_p_u * V[i] + disc_p_m * V[i + 1] + disc_p_d * V[i + 2],std::max(0.0, K - S0 * pow(u, j - i))); 
-                }
+                V[i] = black_scholes_price(S[i], K, dt, sigma, r, q, type == "put");
             }
-            // calculate price, delta, gamma, theta
-            price = V[0];
-            delta1 = (V10 - V12) / (S0 * (u - d));
-            gamma1 = ((V20 - V22) / (S0 * u * (u - d)) - (V22 - V24) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
-            theta1 = (V11 - price) / dt;
+            backwardInduction(N - 1);
         }
         else if (method == "TBSR")
         {
             TrinomialAmerican tree_N = TrinomialAmerican(S0, K, r, sigma, T, q, N, "TBS", type);
             TrinomialAmerican tree_halfN = TrinomialAmerican(S0, K, r, sigma, T, q, N / 2, "TBS", type);
+            tree_N.setTiling(tile_width, tile_levels);
+            tree_N.setThreads(threads);
+            tree_N.setBoundaryTracking(track_boundary);
+            tree_halfN.setTiling(tile_width, tile_levels);
+            tree_halfN.setThreads(threads);
+            tree_halfN.setBoundaryTracking(track_boundary);
             tree_N.runSimulation();
+            boundary = tree_N.boundary;
             tree_halfN.runSimulation();
             price = 2 * tree_N.getPrice() - tree_halfN.getPrice();
             delta1 = 2 * tree_N.getDelta() - tree_halfN.getDelta();
@@ -0,0 +1,161 @@
+#ifndef TrinomialControlVariate_hpp
+#define TrinomialControlVariate_hpp
+
+#include "black_scholes.hpp"
+#include "trinomial_option.hpp"
+#include "lattice_kernel.hpp"
+
+// American price and Greeks corrected with the European tree as control variate,
+//   American tree - European tree + Black-Scholes,
+// from one backward sweep over the shared nodes and leaves; the European values are stepped on a band of
+// `truncation` standard deviations only, as in BinomialControlVariate. Serial: ignores tiling and threads.
+class TrinomialControlVariate : public TrinomialOption
+{
+private:
+    struct Values
+    {
+        double price, delta, gamma, theta;
+    };
+    LatticeBuffer A, E; // American and European node values
+    TrinomialSpotTable spots;
+    TrinomialExerciseTable exercise;
+    double truncation = 10.0;
+    Values american, european, corrected;
+
+    int bandWidth() const
+    {
+        double width = (truncation * sigma * sqrt(T) + std::abs(r - q - sigma * sigma / 2) * T) / log(u);
+        return std::max(2, int(ceil(width)));
+    }
+    int bandLow(int j, int W) const { return std::max(0, j - W); }
+    int bandHigh(int j, int W) const { return std::min(2 * j, j + W); }
+
+    double payoff(double S) const { return type == "put" ? std::max(0.0, K - S) : std::max(0.0, S - K); }
+
+    // European value of node i of level j, used for the nodes just outside the band
+    double nodeValue(int j, int i) const
+    {
+        double S = spots.level(j)[i];
+        if (j == N)
+            return payoff(S);
+        return black_scholes_price(S, K, (N - j) * dt, sigma, r, q, type == "put");
+    }
+
+    // level 1 nodes V1[0..2], level 2 nodes V2[0, 2, 4]
+    Values greeks(const double *V1, const double *V2, double price) const
+    {
+        Values g;
+        g.price = price;
+        g.delta = (V1[0] - V1[2]) / (S0 * (u - d));
+        g.gamma = ((V2[0] - V2[2]) / (S0 * u * (u - d)) - (V2[2] - V2[4]) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
+        g.theta = (V1[1] - price) / dt;
+        return g;
+    }
+
+    // Both inductions from the leaves already stored in A (and copied to E) at level top down to the root
+    void backwardInduction(int top)
+    {
+        FlushDenormals ftz;
+        exercise.build(spots, K, N, type == "put");
+        E.assign(A.begin(), A.end());
+        int W = truncation > 0 ? bandWidth() : top;
+        double A1[3], A2[5], E1[3], E2[5];
+        for (int j = top - 1; j >= 0; j--)
+        {
+            if (j == 0)
+            {
+                std::copy(A.data(), A.data() + 3, A1);
+                std::copy(E.data(), E.data() + 3, E1);
+            }
+            if (j == 1)
+            {
+                std::copy(A.data(), A.data() + 5, A2);
+                std::copy(E.data(), E.data() + 5, E2);
+            }
+            trinomial_step_american(A.data(), exercise.level(j), j, disc_p_u, disc_p_m, disc_p_d);
+            int lo = j >= 2 ? bandLow(j, W) : 0, hi = j >= 2 ? bandHigh(j, W) : 2 * j;
+            for (int i = lo; i < bandLow(j + 1, W); i++)
+                E[i] = nodeValue(j + 1, i);
+            for (int i = bandHigh(j + 1, W) + 1; i <= hi + 2; i++)
+                E[i] = nodeValue(j + 1, i);
+            trinomial_range(E.data() + lo, hi - lo, disc_p_u, disc_p_m, disc_p_d);
+        }
+        american = greeks(A1, A2, A[0]);
+        european = greeks(E1, E2, E[0]);
+    }
+
+public:
+    TrinomialControlVariate(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
+        : TrinomialOption(S0_, K_, r_, sigma_, T_, q_, N_, method_, type_)
+    {
+        if (method != "Trinomial" && method != "TBS" && method != "TBSR")
+        {
+            std::cout << "Method not found!" << std::endl;
+        }
+    }
+
+    // variance reduced price and Greeks
+    double getPrice() const { return corrected.price; }
+    double getDelta() const { return corrected.delta; }
+    double getGamma() const { return corrected.gamma; }
+    double getTheta() const { return corrected.theta; }
+
+    // the two trees on their own
+    double getAmericanPrice() const { return american.price; }
+    double getEuropeanPrice() const { return european.price; }
+
+    // Half-width of the European band in standard deviations, 0 steps the whole European lattice
+    void setTruncation(double nsd) { truncation = nsd; }
+
+    void runSimulation()
+    {
+        if (method == "Trinomial")
+        {
+            A.resize(2 * N + 1);
+            spots.build(S0, u, d, N);
+            const double *S = spots.level(N);
+            for (int i = 0; i <= 2 * N; i++)
+            {
+                A[i] = payoff(S[i]);
+            }
+            backwardInduction(N);
+        }
+        else if (method == "TBS")
+        {
+            A.resize(2 * N - 1);
+            spots.build(S0, u, d, N);
+            const double *S = spots.level(N - 1);
+            for (int i = 0; i <= 2 * N - 2; i++)
+            {
+                A[i] = black_scholes_price(S[i], K, dt, sigma, r, q, type == "put");
+            }
+            backwardInduction(N - 1);
+        }
+        else if (method == "TBSR")
+        {
+            TrinomialControlVariate tree_N(S0, K, r, sigma, T, q, N, "TBS", type);
+            TrinomialControlVariate tree_halfN(S0, K, r, sigma, T, q, N / 2, "TBS", type);
+            tree_N.setTruncation(truncation);
+            tree_halfN.setTruncation(truncation);
+            tree_N.runSimulation();
+            tree_halfN.runSimulation();
+            auto richardson = [](const Values &x, const Values &y) {
+                return Values{2 * x.price - y.price, 2 * x.delta - y.delta, 2 * x.gamma - y.gamma, 2 * x.theta - y.theta};
+            };
+            american = richardson(tree_N.american, tree_halfN.american);
+            european = richardson(tree_N.european, tree_halfN.european);
+        }
+        else
+        {
+            std::cout << "Method not found!" << std::endl;
+            return;
+        }
+        std::map<std::string, double> bs = black_scholes_values(S0, K, T, sigma, r, q);
+        corrected.price = american.price - european.price + bs[type + "_price"];
+        corrected.delta = american.delta - european.delta + bs[type + "_delta"];
+        corrected.gamma = american.gamma - european.gamma + bs["gamma"];
+        corrected.theta = american.theta - european.theta + bs[type + "_theta"];
+    }
+};
+
+#endif
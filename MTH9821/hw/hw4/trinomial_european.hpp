@@ -9,6 +9,7 @@
 */
 #include "black_scholes.hpp"
 #include "trinomial_option.hpp"
+#include "lattice_parallel.hpp"
 
 #ifndef Option_value
 #define Option_value
@@ -34,28 +35,97 @@ class TrinomialEuropean : public TrinomialOption
 {
 private:
     std::vector<std::string> methods{"Trinomial", "TBS", "TBSR"}; // KEEP THIS and below
-    double S_temp;
-    std::vector<double> V;
+    LatticeBuffer V; // reused across runs, sized to the leaf level on every call
+    TrinomialSpotTable spots;
     double V10, V11, V20, V22, V12, V24;
     double price, delta1, gamma1, theta1;
+    double truncation = 0.0; // half-width of the truncated lattice in standard deviations, 0 = full lattice
 
-public:
-    TrinomialEuropean(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
-        : TrinomialOption(S0_, K_, r_, sigma_, T_, q_, N_, method_, type_)
+    // Truncated lattice: node i of level j sits at S0 * u^e, e = j - i, and only the nodes with |e| <= W are
+    // stepped. W covers `truncation` standard deviations of ln(S_T / S0) plus the drift over T, so each level
+    // costs O(W) = O(sqrt(N)) instead of O(N).
+    int bandWidth() const
     {
-        if (method == "Trinomial")
+        double width = (truncation * sigma * sqrt(T) + std::abs(r - q - sigma * sigma / 2) * T) / log(u);
+        return std::max(2, int(ceil(width)));
+    }
+    int bandLow(int j, int W) const { return std::max(0, j - W); }
+    int bandHigh(int j, int W) const { return std::min(2 * j, j + W); }
+
+    // Black-Scholes value of node i of level j, used for the nodes just outside the band
+    double nodeValue(int j, int i) const
+    {
+        double S = spots.level(j)[i];
+        if (j == N)
+            return option_value(K, S, type);
+        return black_scholes_price(S, K, (N - j) * dt, sigma, r, q, type == "put");
+    }
+
+    // Levels top - 1 down to 2 on the band only; the children of the band's edge nodes that fall outside
+    // the band of the level above take their Black-Scholes value
+    void truncatedInduction(int top)
+    {
+        int W = bandWidth();
+        for (int j = top - 1; j >= 2; j--)
         {
-            S_temp = S0 * pow(u, N);
+            int lo = bandLow(j, W), hi = bandHigh(j, W);
+            for (int i = lo; i < bandLow(j + 1, W); i++)
+                V[i] = nodeValue(j + 1, i);
+            for (int i = bandHigh(j + 1, W) + 1; i <= hi + 2; i++)
+                V[i] = nodeValue(j + 1, i);
+            trinomial_range(V.data() + lo, hi - lo, disc_p_u, disc_p_m, disc_p_d);
         }
-        else if (method == "TBS")
+    }
+
+    // Backward induction from the leaves already stored in V at level top down to the root
+    LATTICE_NO_FMA void backwardInduction(int top)
+    {
+        FlushDenormals ftz;
+        int j = top - 1;
+        // truncated, parallel or blocked sweep down to level 2, the last two levels are stepped below to record the Greeks
+        if (truncation > 0 && top > 2)
         {
-            S_temp = S0 * pow(u, N - 1);
+            truncatedInduction(top);
+            j = 1;
         }
-        else if (method == "TBSR")
+        else if (threads > 1 && top > 2)
         {
-            // do nothing
+            trinomial_induction_parallel(V.data(), top, 2, disc_p_u, disc_p_m, disc_p_d, nullptr, threads, tile_levels > 0 ? tile_levels : 32);
+            j = 1;
         }
-        else
+        else if (tile_width > 0 && tile_levels > 0 && top > 2)
+        {
+            trinomial_induction_tiled(V.data(), top, 2, disc_p_u, disc_p_m, disc_p_d, nullptr, tile_width, tile_levels);
+            j = 1;
+        }
+        for (; j >= 0; j--)
+        {
+            if (j == 0)
+            {
+                V10 = V[0];
+                V11 = V[1];
+                V12 = V[2];
+            }
+            if (j == 1)
+            {
+                V20 = V[0];
+                V22 = V[2];
+                V24 = V[4];
+            }
+            trinomial_step(V.data(), j, disc_p_u, disc_p_m, disc_p_d);
+        }
+        // calculate price, delta, gamma, theta
+        price = V[0];
+        delta1 = (V10 - V12) / (S0 * (u - d));
+        gamma1 = ((V20 - V22) / (S0 * u * (u - d)) - (V22 - V24) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
+        theta1 = (V11 - price) / dt;
+    }
+
+public:
+    TrinomialEuropean(double S0_, double K_, double r_, double sigma_, double T_, double q_, int N_, std::string method_, std::string type_)
+        : TrinomialOption(S0_, K_, r_, sigma_, T_, q_, N_, method_, type_)
+    {
+        if (method != "Trinomial" && method != "TBS" && method != "TBSR")
         {
             std::cout << "Method not found!" << std::endl;
         }
@@ -67,74 +137,46 @@ public:
     double getGamma() const { return gamma1; }
     double getTheta() const { return theta1; }
 
+    // Step only the nodes within nsd standard deviations (plus drift) of the spot and give the nodes just
+    // outside their Black-Scholes value; serial, ignores tiling and threads. 0 restores the full lattice.
+    void setTruncation(double nsd) { truncation = nsd; }
+
     void runSimulation()
     {
         if (method == "Trinomial")
         {
-            for (int i = 0; i <= 2 * N; i++)
+            V.resize(2 * N + 1);
+            spots.build(S0, u, d, N);
+            const double *S = spots.level(N);
+            int lo = truncation > 0 ? bandLow(N, bandWidth()) : 0, hi = truncation > 0 ? bandHigh(N, bandWidth()) : 2 * N;
+            for (int i = lo; i <= hi; i++)
             {
-                V.push_back(option_value(K, S0 * pow(u, N - i), type));
+                V[i] = option_value(K, S[i], type);
             }
-            for (int j = N - 1; j >= 0; j--)
-            {
-                if (j == 0)
-                {
-                    V10 = V[0];
-                    V11 = V[1];
-                    V12 = V[2];
-                }
-                if (j == 1)
-                {
-                    V20 = V[0];
-                    V22 = V[2];
-                    V24 = V[4];
-                }
-                for (int i = 0; i <= 2 * j; i++)
-                {
-                    V[i] = disc_p_u * V[i] + disc_p_m * V[i + 1] + disc_p_d * V[i + 2]; 
-                }
-            }
-            // calculate price, delta, gamma, theta
-            price = V[0];
-            delta1 = (V10 - V12) / (S0 * (u - d));
-            gamma1 = ((V20 - V22) / (S0 * u * (u - d)) - (V22 - V24) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
-            theta1 = (V11 - price) / dt;
+            backwardInduction(N);
         }
         else if (method == "TBS")
         {
-            for (int i = 0; i <= 2*N - 2; i++)
-            {
-                V.push_back(black_scholes_values(S0 * pow(u, N - i), K, dt, sigma, r, q)[type + "_price"]);
-            }
-            for (int j = N - 2; j >= 0; j--)
+            V.resize(2 * N - 1);
+            spots.build(S0, u, d, N);
+            const double *S = spots.level(N - 1);
+            int lo = truncation > 0 ? bandLow(N - 1, bandWidth()) : 0, hi = truncation > 0 ? bandHigh(N - 1, bandWidth()) : 2 * N - 2;
+            for (int i = lo; i <= hi; i++)
             {
-                if (j == 0)
-                {
-                    V10 = V[0];
-                    V11 = V[1];
-                    V12 = V[2];
-                }
-                if (j == 1)
-                {
-                    V20 = V[0];
-                    V22 = V[2];
-                    V24 = V[4];
-                }
-                for (int i = 0; i <= 2 * j; i++)
-                {
-                    V[i] = disc_p_u * V[i] + disc_p_m * V[i + 1] + disc_p_d * V[i + 2];
-                }
+                V[i] = black_scholes_price(S[i], K, dt, sigma, r, q, type == "put");
             }
-            // calculate price, delta, gamma, theta
-            price = V[0];
-            delta1 = (V10 - V12) / (S0 * (u - d));
-            gamma1 = ((V20 - V22) / (S0 * u * (u - d)) - (V22 - V24) / (S0 * d * (u - d))) / (S0 * (u * u - d * d) / 2);
-            theta1 = (V11 - price) / dt;
+            backwardInduction(N - 1);
         }
         else if (method == "TBSR")
         {
             TrinomialEuropean tree_N = TrinomialEuropean(S0, K, r, sigma, T, q, N, "TBS", type);
             TrinomialEuropean tree_halfN = TrinomialEuropean(S0, K, r, sigma, T, q, N / 2, "TBS", type);
+            tree_N.setTiling(tile_width, tile_levels);
+            tree_N.setThreads(threads);
+            tree_N.setTruncation(truncation);
+            tree_halfN.setTiling(tile_width, tile_levels);
+            tree_halfN.setThreads(threads);
+            tree_halfN.setTruncation(truncation);
             tree_N.runSimulation();
             tree_halfN.runSimulation();
             price = 2 * tree_N.getPrice() - tree_halfN.getPrice();
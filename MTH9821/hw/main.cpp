@@ -14,12 +14,13 @@ int main() {
     double alpha_temp = 0.45;
     double M = 4;
     FDMEuropean FDM(option, M, alpha_temp, true); // true because put option
-    std::vector<std::vector<double>> mesh = FDM.mesh;
-    for (int i=0; i < mesh.size(); i++){
-        for (int j=0; j < mesh[0].size(); j++){
-            std::cout << mesh[i][j] << "  ";
+    const FDMMesh& mesh = FDM.mesh;
+    for (int i=0; i < mesh.rows(); i++){
+        for (int j=0; j < mesh.cols(); j++){
+            std::cout << mesh(i, j) << "  ";
         }
         std::cout << std::endl;
     }
+    std::cout << "Price: " << FDM.price << "  Delta: " << FDM.delta << "  Gamma: " << FDM.gamma << "  Theta: " << FDM.theta << std::endl;
     return 0;
 }
\ No newline at end of file